@@ -0,0 +1,57 @@
+/*!
+ * \file InputPortsDialog.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the MIDI inputs listened to in addition to the main input
+ */
+
+#include "InputPortsDialog.h"
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QDialogButtonBox>
+
+//Constructor
+InputPortsDialog::InputPortsDialog( QWidget *parent )
+    : QDialog( parent )
+{
+    setWindowTitle( tr( "Additional MIDI Inputs" ) );
+
+    m_list = new QListWidget( this );
+
+    QVBoxLayout *layout = new QVBoxLayout( this );
+    layout->addWidget( new QLabel( tr( "Also listen to these inputs (pedals, keyboards...):" ) ) );
+    layout->addWidget( m_list );
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, this );
+    connect( buttonBox, SIGNAL(accepted()), this, SLOT(accept()) );
+    connect( buttonBox, SIGNAL(rejected()), this, SLOT(reject()) );
+    layout->addWidget( buttonBox );
+}
+
+//Fill the list, checked ports which are not connected right now are kept
+void InputPortsDialog::setPorts( const QStringList &ports, const QStringList &checkedPorts )
+{
+    m_list->clear();
+    QStringList allPorts = ports;
+    foreach( QString port, checkedPorts )
+    {
+        if( !allPorts.contains( port ) ) allPorts.append( port );
+    }
+    foreach( QString port, allPorts )
+    {
+        QListWidgetItem *item = new QListWidgetItem( port, m_list );
+        item->setFlags( item->flags() | Qt::ItemIsUserCheckable );
+        item->setCheckState( checkedPorts.contains( port ) ? Qt::Checked : Qt::Unchecked );
+    }
+}
+
+//Ports selected by the user
+QStringList InputPortsDialog::checkedPorts( void ) const
+{
+    QStringList ports;
+    for( int i = 0; i < m_list->count(); i++ )
+    {
+        if( m_list->item( i )->checkState() == Qt::Checked ) ports.append( m_list->item( i )->text() );
+    }
+    return ports;
+}
@@ -0,0 +1,26 @@
+/*!
+ * \file InputPortsDialog.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the MIDI inputs listened to in addition to the main input
+ */
+
+#ifndef INPUTPORTSDIALOG_H
+#define INPUTPORTSDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+
+class InputPortsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit InputPortsDialog( QWidget *parent = 0 );
+    void setPorts( const QStringList &ports, const QStringList &checkedPorts );
+    QStringList checkedPorts( void ) const;
+
+private:
+    QListWidget *m_list;
+};
+
+#endif // INPUTPORTSDIALOG_H
@@ -0,0 +1,125 @@
+/*!
+ * \file LatencyDialog.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog showing the latency statistics of all stages
+ */
+
+#include "LatencyDialog.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QFile>
+#include <QDir>
+#include <QJsonDocument>
+#include <QMessageBox>
+
+//Constructor
+LatencyDialog::LatencyDialog( LatencyStats *stats, QMidiIn *midiIn, QWidget *parent )
+    : QDialog( parent )
+    , m_stats( stats )
+    , m_midiIn( midiIn )
+{
+    setWindowTitle( tr( "Latency Statistics" ) );
+
+    QVBoxLayout *layout = new QVBoxLayout( this );
+
+    m_table = new QTableWidget( LATENCY_STAGES, 6, this );
+    m_table->setHorizontalHeaderLabels( QStringList() << tr( "Count" ) << tr( "Mean (ms)" ) << tr( "50% (ms)" )
+                                                      << tr( "95% (ms)" ) << tr( "99% (ms)" ) << tr( "Max (ms)" ) );
+    QStringList stageNames;
+    for( int i = 0; i < LATENCY_STAGES; i++ ) stageNames.append( LatencyStats::stageName( (LatencyStage)i ) );
+    m_table->setVerticalHeaderLabels( stageNames );
+    m_table->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    m_table->setSelectionMode( QAbstractItemView::NoSelection );
+#if QT_VERSION >= 0x050000
+    m_table->horizontalHeader()->setSectionResizeMode( QHeaderView::Stretch );
+#else
+    m_table->horizontalHeader()->setResizeMode( QHeaderView::Stretch );
+#endif
+    for( int row = 0; row < LATENCY_STAGES; row++ )
+    {
+        for( int column = 0; column < 6; column++ )
+        {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment( Qt::AlignRight | Qt::AlignVCenter );
+            m_table->setItem( row, column, item );
+        }
+    }
+    m_table->setMinimumWidth( 600 );
+    layout->addWidget( m_table );
+
+    m_inputQueueLabel = new QLabel( this );
+    layout->addWidget( m_inputQueueLabel );
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox( QDialogButtonBox::Close, Qt::Horizontal, this );
+    QPushButton *resetButton = buttonBox->addButton( tr( "Reset" ), QDialogButtonBox::ResetRole );
+    QPushButton *exportButton = buttonBox->addButton( tr( "Export JSON..." ), QDialogButtonBox::ActionRole );
+    connect( resetButton, SIGNAL(clicked()), this, SLOT(reset()) );
+    connect( exportButton, SIGNAL(clicked()), this, SLOT(exportJson()) );
+    connect( buttonBox, SIGNAL(rejected()), this, SLOT(reject()) );
+    layout->addWidget( buttonBox );
+
+    //Values change while sending, keep them up to date
+    m_timer = new QTimer( this );
+    connect( m_timer, SIGNAL(timeout()), this, SLOT(refresh()) );
+    m_timer->start( 500 );
+    refresh();
+}
+
+//Show current values
+void LatencyDialog::refresh( void )
+{
+    for( int i = 0; i < LATENCY_STAGES; i++ )
+    {
+        const LatencyHistogram &histogram = m_stats->histogram( (LatencyStage)i );
+        int count = histogram.count();
+        m_table->item( i, 0 )->setText( QString::number( count ) );
+        if( count == 0 )
+        {
+            for( int column = 1; column < 6; column++ ) m_table->item( i, column )->setText( "-" );
+            continue;
+        }
+        m_table->item( i, 1 )->setText( QString::number( histogram.sum() / count / 1000000.0, 'f', 3 ) );
+        m_table->item( i, 2 )->setText( QString::number( histogram.percentile( 50 ) / 1000000.0, 'f', 3 ) );
+        m_table->item( i, 3 )->setText( QString::number( histogram.percentile( 95 ) / 1000000.0, 'f', 3 ) );
+        m_table->item( i, 4 )->setText( QString::number( histogram.percentile( 99 ) / 1000000.0, 'f', 3 ) );
+        m_table->item( i, 5 )->setText( QString::number( histogram.max() / 1000000.0, 'f', 3 ) );
+    }
+
+    //Overruns mean incoming MIDI was lost
+    m_inputQueueLabel->setText( tr( "MIDI input queue: %1 waiting, peak %2, %3 overruns, %4 sysex dropped, %5 read errors" )
+                                .arg( m_midiIn->eventQueueFill() )
+                                .arg( m_midiIn->eventQueueHighWater() )
+                                .arg( m_midiIn->eventQueueOverruns() )
+                                .arg( m_midiIn->droppedSysex() )
+                                .arg( m_midiIn->inputErrors() ) );
+}
+
+//Forget all measurements, e.g. after soundcheck
+void LatencyDialog::reset( void )
+{
+    m_stats->reset();
+    m_midiIn->resetEventQueueStatistics();
+    refresh();
+}
+
+//Save all histograms for comparison with other sessions
+void LatencyDialog::exportJson( void )
+{
+    QString fileName = QFileDialog::getSaveFileName( this, tr( "Export Latency Statistics" ),
+                                                     QDir::homePath(), tr( "JSON (*.json)" ) );
+    if( fileName.isEmpty() ) return;
+    if( !fileName.endsWith( ".json", Qt::CaseInsensitive ) ) fileName.append( ".json" );
+
+    QFile file( fileName );
+    if( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        QMessageBox::critical( this, windowTitle(), tr( "Could not write %1." ).arg( fileName ) );
+        return;
+    }
+    file.write( QJsonDocument( m_stats->toJson() ).toJson() );
+    file.close();
+}
@@ -0,0 +1,37 @@
+/*!
+ * \file LatencyDialog.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog showing the latency statistics of all stages
+ */
+
+#ifndef LATENCYDIALOG_H
+#define LATENCYDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QTimer>
+#include <QLabel>
+#include "LatencyStats.h"
+#include "qmidiin.h"
+
+class LatencyDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit LatencyDialog( LatencyStats *stats, QMidiIn *midiIn, QWidget *parent = 0 );
+
+private slots:
+    void refresh( void );
+    void reset( void );
+    void exportJson( void );
+
+private:
+    LatencyStats *m_stats;
+    QMidiIn *m_midiIn;
+    QTableWidget *m_table;
+    QLabel *m_inputQueueLabel;
+    QTimer *m_timer;
+};
+
+#endif // LATENCYDIALOG_H
@@ -0,0 +1,197 @@
+/*!
+ * \file LatencyStats.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Lock-free latency histograms for each stage from program change to last sysex byte
+ */
+
+#include "LatencyStats.h"
+#include <QJsonArray>
+#include <QDateTime>
+#include <QObject>
+#include "qmidievent.h"
+
+//Names of the stages in exported files, never translated
+static const char *stageKeys[LATENCY_STAGES] =
+{
+    "receive", "dispatch", "settle", "fileRead", "queue", "portOpen", "encodeDrain", "total"
+};
+
+//Constructor
+LatencyHistogram::LatencyHistogram()
+    : m_count( 0 )
+    , m_sum( 0 )
+    , m_max( 0 )
+{
+    for( int i = 0; i < LATENCY_BUCKETS; i++ ) m_buckets[i].store( 0 );
+}
+
+//Add one measurement, may be called from any thread
+void LatencyHistogram::add( qint64 nsecs )
+{
+    if( nsecs < 0 ) nsecs = 0;
+
+    //log2 of the microseconds
+    qint64 usecs = nsecs / 1000;
+    int bucket = 0;
+    while( usecs > 0 && bucket < LATENCY_BUCKETS - 1 )
+    {
+        usecs >>= 1;
+        bucket++;
+    }
+
+    m_buckets[bucket].fetchAndAddRelaxed( 1 );
+    m_count.fetchAndAddRelaxed( 1 );
+    m_sum.fetchAndAddRelaxed( nsecs );
+
+    qint64 max = m_max.load();
+    while( nsecs > max && !m_max.testAndSetRelaxed( max, nsecs, max ) ) {}
+}
+
+//Forget all measurements
+void LatencyHistogram::reset( void )
+{
+    for( int i = 0; i < LATENCY_BUCKETS; i++ ) m_buckets[i].store( 0 );
+    m_count.store( 0 );
+    m_sum.store( 0 );
+    m_max.store( 0 );
+}
+
+//Number of measurements
+int LatencyHistogram::count( void ) const
+{
+    return m_count.load();
+}
+
+//Number of measurements in one bucket
+int LatencyHistogram::bucketCount( int bucket ) const
+{
+    return m_buckets[bucket].load();
+}
+
+//Sum of all measurements in ns
+qint64 LatencyHistogram::sum( void ) const
+{
+    return m_sum.load();
+}
+
+//Slowest measurement in ns
+qint64 LatencyHistogram::max( void ) const
+{
+    return m_max.load();
+}
+
+//Upper limit (ns) below which the given percentage of measurements is, bucket resolution
+qint64 LatencyHistogram::percentile( double percent ) const
+{
+    int count = m_count.load();
+    if( count == 0 ) return 0;
+
+    qint64 wanted = (qint64)( count * percent / 100.0 + 0.5 );
+    if( wanted < 1 ) wanted = 1;
+    qint64 seen = 0;
+    for( int i = 0; i < LATENCY_BUCKETS; i++ )
+    {
+        seen += m_buckets[i].load();
+        if( seen >= wanted ) return qMin( bucketLimit( i ), max() );
+    }
+    return max();
+}
+
+//Exclusive upper limit of a bucket in ns
+qint64 LatencyHistogram::bucketLimit( int bucket )
+{
+    return ( Q_INT64_C( 1 ) << bucket ) * 1000;
+}
+
+//Constructor
+LatencyStats::LatencyStats()
+{
+}
+
+//Add a measurement for a stage
+void LatencyStats::record( LatencyStage stage, qint64 nsecs )
+{
+    m_histograms[stage].add( nsecs );
+}
+
+//Add the time since start for a stage, returns the current time
+qint64 LatencyStats::recordSince( LatencyStage stage, qint64 start )
+{
+    qint64 time = now();
+    m_histograms[stage].add( time - start );
+    return time;
+}
+
+//Histogram of a stage
+const LatencyHistogram &LatencyStats::histogram( LatencyStage stage ) const
+{
+    return m_histograms[stage];
+}
+
+//Forget all measurements
+void LatencyStats::reset( void )
+{
+    for( int i = 0; i < LATENCY_STAGES; i++ ) m_histograms[i].reset();
+}
+
+//All stages as JSON, times in us
+QJsonObject LatencyStats::toJson( void ) const
+{
+    QJsonArray stages;
+    for( int i = 0; i < LATENCY_STAGES; i++ )
+    {
+        const LatencyHistogram &histogram = m_histograms[i];
+        QJsonObject stage;
+        stage.insert( "name", QString( stageKeys[i] ) );
+        stage.insert( "count", histogram.count() );
+        stage.insert( "mean", histogram.count() ? histogram.sum() / histogram.count() / 1000.0 : 0.0 );
+        stage.insert( "p50", histogram.percentile( 50 ) / 1000.0 );
+        stage.insert( "p95", histogram.percentile( 95 ) / 1000.0 );
+        stage.insert( "p99", histogram.percentile( 99 ) / 1000.0 );
+        stage.insert( "max", histogram.max() / 1000.0 );
+
+        //Only filled buckets, "below" is the exclusive upper limit
+        QJsonArray buckets;
+        for( int b = 0; b < LATENCY_BUCKETS; b++ )
+        {
+            if( histogram.bucketCount( b ) == 0 ) continue;
+            QJsonObject bucket;
+            bucket.insert( "below", LatencyHistogram::bucketLimit( b ) / 1000.0 );
+            bucket.insert( "count", histogram.bucketCount( b ) );
+            buckets.append( bucket );
+        }
+        stage.insert( "buckets", buckets );
+        stages.append( stage );
+    }
+
+    QJsonObject root;
+    root.insert( "application", QString( "SysexLive" ) );
+    root.insert( "created", QDateTime::currentDateTime().toString( Qt::ISODate ) );
+    root.insert( "unit", QString( "us" ) );
+    root.insert( "stages", stages );
+    return root;
+}
+
+//Current time in ns, same clock as the MIDI input timestamps
+qint64 LatencyStats::now( void )
+{
+    return QMidiEvent::currentTimestamp();
+}
+
+//Readable name of a stage
+QString LatencyStats::stageName( LatencyStage stage )
+{
+    switch( stage )
+    {
+    case LatencyReceive: return QObject::tr( "Receive" );
+    case LatencyDispatch: return QObject::tr( "GUI dispatch" );
+    case LatencySettle: return QObject::tr( "Settle window" );
+    case LatencyFileRead: return QObject::tr( "File read" );
+    case LatencyQueue: return QObject::tr( "Port queue" );
+    case LatencyPortOpen: return QObject::tr( "Port open" );
+    case LatencyEncodeDrain: return QObject::tr( "Encode & drain" );
+    case LatencyTotal: return QObject::tr( "Total" );
+    default: return QString();
+    }
+}
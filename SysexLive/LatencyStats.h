@@ -0,0 +1,71 @@
+/*!
+ * \file LatencyStats.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Lock-free latency histograms for each stage from program change to last sysex byte
+ */
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QString>
+#include <QJsonObject>
+
+//Stages of the way from program change to synth
+enum LatencyStage
+{
+    LatencyReceive = 0,     //MIDI input callback until handed over to the GUI thread
+    LatencyDispatch,        //Hand over until the GUI thread handles the program change
+    LatencySettle,          //Waiting for further program changes
+    LatencyFileRead,        //Getting the patches of the entry
+    LatencyQueue,           //Job submitted until the port thread starts sending
+    LatencyPortOpen,        //Opening a MIDI output port
+    LatencyEncodeDrain,     //Encoding and draining one sysex message
+    LatencyTotal,           //Program change until the last byte of the last synth left
+    LATENCY_STAGES
+};
+
+//Bucket 0: < 1us, bucket n: < 2^n us
+#define LATENCY_BUCKETS 32
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+    void add( qint64 nsecs );
+    void reset( void );
+    int count( void ) const;
+    int bucketCount( int bucket ) const;
+    qint64 sum( void ) const;
+    qint64 max( void ) const;
+    qint64 percentile( double percent ) const;
+    static qint64 bucketLimit( int bucket );
+
+private:
+    QAtomicInt m_buckets[LATENCY_BUCKETS];
+    QAtomicInt m_count;
+    QAtomicInteger<qint64> m_sum;
+    QAtomicInteger<qint64> m_max;
+    Q_DISABLE_COPY( LatencyHistogram )
+};
+
+class LatencyStats
+{
+public:
+    LatencyStats();
+    void record( LatencyStage stage, qint64 nsecs );
+    qint64 recordSince( LatencyStage stage, qint64 start );
+    const LatencyHistogram &histogram( LatencyStage stage ) const;
+    void reset( void );
+    QJsonObject toJson( void ) const;
+    static qint64 now( void );
+    static QString stageName( LatencyStage stage );
+
+private:
+    LatencyHistogram m_histograms[LATENCY_STAGES];
+    Q_DISABLE_COPY( LatencyStats )
+};
+
+#endif // LATENCYSTATS_H
@@ -14,15 +14,29 @@
 #include <QDir>
 #include <QFileDialog>
 #include <QXmlStreamWriter>
+#include <QInputDialog>
 #include "DarkStyle.h"
+#include "PacingDialog.h"
+#include "LatencyDialog.h"
+#include "ProgramAddressDialog.h"
+#include "InputPortsDialog.h"
+#include "RealtimeDialog.h"
+#include "qmiditrace.h"
 
 #define APPNAME "SysexLive"
 #define VERSION "0.2"
 
+//Program change address of an entry, stored in its name item
+#define ROLE_CHANNEL Qt::UserRole
+#define ROLE_BANK    Qt::UserRole + 1
+#define ROLE_PROGRAM Qt::UserRole + 2
+
 //Constructor
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_requestTimestamp(0),
+    m_settleStart(0)
 {
     ui->setupUi(this);
 
@@ -34,11 +48,44 @@ MainWindow::MainWindow(QWidget *parent) :
     CDarkStyle::assign();
 #endif
 
+    //The MIDI transport is chosen once, before any port is created
+#ifdef Q_OS_LINUX
+    if( QSettings( QSettings::UserScope, "masc.SysexLive", "SysexLive" ).value( "rawMidi", false ).toBool() )
+    {
+        QMidiIn::setDefaultApi( RtMidi::LINUX_ALSA_RAW );
+        QMidiOut::setDefaultApi( RtMidi::LINUX_ALSA_RAW );
+    }
+#endif
     m_midiIn = new QMidiIn( this );
-    m_midiOut = new QMidiOut( this );
+    //Only program changes and bank select are used, the rest is dropped on the MIDI thread
+    m_midiIn->setMessageFilter( QList<QMidiStatus>() << MIDI_PROGRAM_CHANGE << MIDI_CONTROL_CHANGE );
+    //Ports are enumerated once and then follow the announcements of the system
+    m_portRegistry = new QMidiPortRegistry( this );
+    m_midiIn->setPortRegistry( m_portRegistry );
+    m_patchCache = new PatchCache( this );
+    m_prefetcher = new Prefetcher( m_patchCache, this );
+    m_sendEngine = new SendEngine( this );
+    connect( m_sendEngine, SIGNAL(portFinished(int)), this, SLOT(onPortFinished(int)) );
+    connect( m_sendEngine, SIGNAL(portError(int,const QString &)), this, SLOT(onPortError(int,const QString &)) );
+    connect( m_sendEngine, SIGNAL(jobProgress(int,int)), this, SLOT(onJobProgress(int,int)) );
+    connect( m_sendEngine, SIGNAL(jobFinished(int,bool)), this, SLOT(onJobFinished(int,bool)) );
+
+    //Only the latest program change of a burst gets sent
+    m_coalescer = new ProgramChangeCoalescer( this );
+    connect( m_coalescer, SIGNAL(superseded()), m_sendEngine, SLOT(cancel()) );
+    connect( m_coalescer, SIGNAL(settled(int)), this, SLOT(sendRow(int)) );
+
+    //Optional: program changes start sending on the MIDI thread already
+    m_fastPath = new ProgramChangeFastPath( m_sendEngine );
+    m_midiIn->setHandler( m_fastPath );
+    connect( m_patchCache, SIGNAL(patchChanged(const QString &)), this, SLOT(updateFastPathJobs()) );
+    connect( m_patchCache, SIGNAL(patchChanged(const QString &)), m_sendEngine, SLOT(forgetSentPatches()) );
 
     getPorts();
 
+    //Follow synths if interfaces are plugged or unplugged
+    connect( m_portRegistry, SIGNAL(portsChanged()), this, SLOT(onPortsChanged()) );
+
     m_lastSaveFileName = QDir::homePath();
 
     ui->plainTextEdit->setEnabled( false );
@@ -66,6 +113,16 @@ MainWindow::MainWindow(QWidget *parent) :
     connect( m_recentFilesMenu, SIGNAL(recentFileTriggered(const QString &)), this, SLOT(loadFile(const QString &)) );
     ui->menuFile->insertMenu( ui->actionSave, m_recentFilesMenu );
 
+    //MIDI trace only exists if built with CONFIG+=qmidi_trace
+    ui->actionDumpMidiTrace->setVisible( QMidiTrace::isEnabled() );
+
+    //rawmidi is ALSA only
+#ifdef Q_OS_LINUX
+    ui->actionRawMidi->setChecked( QMidiOut::defaultApi() == RtMidi::LINUX_ALSA_RAW );
+#else
+    ui->actionRawMidi->setVisible( false );
+#endif
+
     //Keyfilter on Table
     m_eventFilter = new EventReturnFilter( this );
     ui->tableWidget->installEventFilter( m_eventFilter );
@@ -76,21 +133,33 @@ MainWindow::~MainWindow()
 {
     writeSettings();
     delete m_eventFilter;
-    delete m_midiOut;
+    //MIDI thread may send via the fast path, stop it before the send engine goes
+    m_midiIn->setHandler( 0 );
     if( ui->pushButtonListen->isChecked() ) ui->pushButtonListen->setChecked( false );
     delete m_midiIn;
+    delete m_fastPath;
+    delete m_sendEngine;
     delete ui;
 }
 
 //Get Ports and write into combobox
 void MainWindow::getPorts( void )
+{
+    m_sendEngine->reconnect( m_portRegistry->outputPorts() );
+    ui->comboBoxInput->addItems( m_portRegistry->inputPorts() );
+    ui->comboBoxSynth1->addItems( m_portRegistry->outputPorts() );
+    ui->comboBoxSynth2->addItems( m_portRegistry->outputPorts() );
+    ui->comboBoxSynth3->addItems( m_portRegistry->outputPorts() );
+    ui->comboBoxSynth4->addItems( m_portRegistry->outputPorts() );
+    updatePortAvailability();
+
+    connectSynthPorts();
+}
+
+//Enable the port selection if there are ports
+void MainWindow::updatePortAvailability( void )
 {
     bool portAvailable = true;
-    ui->comboBoxInput->addItems( m_midiIn->getPorts() );
-    ui->comboBoxSynth1->addItems( m_midiOut->getPorts() );
-    ui->comboBoxSynth2->addItems( m_midiOut->getPorts() );
-    ui->comboBoxSynth3->addItems( m_midiOut->getPorts() );
-    ui->comboBoxSynth4->addItems( m_midiOut->getPorts() );
 
     //Block GUI if no port available
     if( ui->comboBoxSynth1->count() == 0 )
@@ -115,6 +184,44 @@ void MainWindow::getPorts( void )
     ui->actionSendPatches->setEnabled( portAvailable );
 }
 
+//Open the output port of every synth slot as selected in the comboboxes
+void MainWindow::connectSynthPorts( void )
+{
+    QComboBox *comboBoxes[4] = { ui->comboBoxSynth1, ui->comboBoxSynth2, ui->comboBoxSynth3, ui->comboBoxSynth4 };
+    for( int i = 0; i < 4; i++ )
+    {
+        if( comboBoxes[i]->count() == 0 || ( i >= 2 && !ui->action4Synths->isChecked() ) )
+        {
+            m_sendEngine->closePort( i );
+            continue;
+        }
+        m_sendEngine->setPortName( i, comboBoxes[i]->currentText() );
+    }
+}
+
+//Interfaces were plugged or unplugged: update the comboboxes and reconnect the synth ports
+void MainWindow::onPortsChanged( void )
+{
+    QComboBox *comboBoxes[5] = { ui->comboBoxInput, ui->comboBoxSynth1, ui->comboBoxSynth2, ui->comboBoxSynth3, ui->comboBoxSynth4 };
+    QString wanted[5] = { m_midiInput, m_synth1, m_synth2, m_synth3, m_synth4 };
+    for( int i = 0; i < 5; i++ )
+    {
+        //Keep the selection, or return to the wanted port when it comes back
+        QString current = comboBoxes[i]->currentText();
+        comboBoxes[i]->blockSignals( true );
+        comboBoxes[i]->clear();
+        comboBoxes[i]->addItems( i == 0 ? m_portRegistry->inputPorts() : m_portRegistry->outputPorts() );
+        int index = comboBoxes[i]->findText( wanted[i] );
+        if( index < 0 ) index = comboBoxes[i]->findText( current );
+        if( index >= 0 ) comboBoxes[i]->setCurrentIndex( index );
+        comboBoxes[i]->blockSignals( false );
+    }
+    updatePortAvailability();
+
+    //Slots follow their port names, no matter where the ports are now
+    m_sendEngine->reconnect( m_portRegistry->outputPorts() );
+}
+
 //Connect ports which were saved in file
 void MainWindow::searchSynths( void )
 {
@@ -165,11 +272,14 @@ void MainWindow::searchSynths( void )
             break;
         }
     }
+
+    connectSynthPorts();
 }
 
 //Find the ports
 void MainWindow::on_actionSearchInterfaces_triggered()
 {
+    m_portRegistry->refresh();
     ui->comboBoxInput->clear();
     ui->comboBoxSynth1->clear();
     ui->comboBoxSynth2->clear();
@@ -224,6 +334,7 @@ void MainWindow::on_actionAddEntry_triggered()
 void MainWindow::on_actionDeleteEntry_triggered()
 {
     ui->tableWidget->removeRow( ui->tableWidget->currentRow() );
+    resetPrefetch();
 }
 
 //Doubleclick in table
@@ -247,6 +358,9 @@ void MainWindow::on_tableWidget_doubleClicked(const QModelIndex &index)
         item->setText( fileName );
         item = ui->tableWidget->item( index.row(), index.column() );
         item->setText( QFileInfo( fileName ).fileName() );
+
+        m_patchCache->addFile( fileName );
+        resetPrefetch();
     }
 }
 
@@ -266,53 +380,158 @@ void MainWindow::on_actionSendPatches_triggered()
         return;
     }
 
-    for( int i = 0; i < 4; i++ )
+    sendRow( row );
+}
+
+//Send patches of a setlist entry
+void MainWindow::sendRow( int row )
+{
+    if( row < 0 || row >= ui->tableWidget->rowCount() ) return;
+
+    LatencyStats *latencyStats = m_sendEngine->latencyStats();
+    qint64 start = LatencyStats::now();
+    if( m_requestTimestamp > 0 ) latencyStats->record( LatencySettle, start - m_settleStart );
+
+    //Normally the job was prepared already when the row got selected
+    SendJob job;
+    if( !m_prefetcher->job( row, job ) )
     {
-        //Get filename
-        QString fileName = ui->tableWidget->item( row, i + 1 )->text();
+        m_prefetcher->prepare( row, rowFileNames( row ) );
+        m_prefetcher->job( row, job );
+    }
+    latencyStats->recordSince( LatencyFileRead, start );
 
-        //Get & check file
-        QFile file( fileName );
-        if( !file.exists() ) continue;
+    //Manual sends are measured from here
+    job.timestamp = m_requestTimestamp > 0 ? m_requestTimestamp : start;
+    m_requestTimestamp = 0;
 
-        //Read from file
-        file.open( QIODevice::ReadOnly );
-        QByteArray syxData = file.readAll();
-        file.close();
+    //Send to all synths in background, a running job is cancelled
+    m_sendEngine->submit( job );
+}
 
-        //Send to synth 1
-        if( i == 0 && ui->comboBoxSynth1->count() != 0 && ui->comboBoxSynth1->currentIndex() < m_midiOut->getPorts().size() )
-        {
-            m_midiOut->openPort( ui->comboBoxSynth1->currentIndex() );
-            std::vector<unsigned char> message( syxData.begin(), syxData.end() );
-            m_midiOut->sendRawMessage( message );
-            m_midiOut->closePort();
-        }
-        //Send to synth 2
-        if( i == 1 && ui->comboBoxSynth2->count() != 0 && ui->comboBoxSynth2->currentIndex() < m_midiOut->getPorts().size() )
-        {
-            m_midiOut->openPort( ui->comboBoxSynth2->currentIndex() );
-            std::vector<unsigned char> message( syxData.begin(), syxData.end() );
-            m_midiOut->sendRawMessage( message );
-            m_midiOut->closePort();
-        }
-        //Send to synth 3
-        if( i == 2 && ui->comboBoxSynth3->count() != 0 && ui->action4Synths->isChecked() && ui->comboBoxSynth3->currentIndex() < m_midiOut->getPorts().size() )
-        {
-            m_midiOut->openPort( ui->comboBoxSynth3->currentIndex() );
-            std::vector<unsigned char> message( syxData.begin(), syxData.end() );
-            m_midiOut->sendRawMessage( message );
-            m_midiOut->closePort();
-        }
-        //Send to synth 4
-        if( i == 3 && ui->comboBoxSynth4->count() != 0 && ui->action4Synths->isChecked() && ui->comboBoxSynth4->currentIndex() < m_midiOut->getPorts().size() )
+//Files of a setlist entry for synth 1..4, empty if synth is not used
+QStringList MainWindow::rowFileNames( int row )
+{
+    QStringList fileNames;
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        //Synth 3 & 4 only if 4 synths are configured
+        if( i >= 2 && !ui->action4Synths->isChecked() ) fileNames.append( QString() );
+        else fileNames.append( ui->tableWidget->item( row, i + 1 )->text() );
+    }
+    return fileNames;
+}
+
+//Prepare the jobs for the entries around the current one, setlists are mostly played in order
+void MainWindow::prefetchAround( int row )
+{
+    if( row < 0 ) return;
+    m_prefetcher->keepRange( row );
+    for( int i = row - PREFETCH_RANGE; i <= row + PREFETCH_RANGE; i++ )
+    {
+        if( i < 0 || i >= ui->tableWidget->rowCount() ) continue;
+        m_prefetcher->prepare( i, rowFileNames( i ) );
+    }
+}
+
+//Setlist was edited, prepared jobs are outdated
+void MainWindow::resetPrefetch( void )
+{
+    m_prefetcher->clear();
+    prefetchAround( ui->tableWidget->currentRow() );
+    updateProgramMap();
+    updateFastPathJobs();
+}
+
+//Program change address of an entry, default if none was set
+ProgramAddress MainWindow::rowAddress( int row )
+{
+    ProgramAddress address;
+    QTableWidgetItem *item = ui->tableWidget->item( row, 0 );
+    if( !item || item->data( ROLE_CHANNEL ).isNull() ) return address;
+    address.channel = item->data( ROLE_CHANNEL ).toInt();
+    address.bank = item->data( ROLE_BANK ).toInt();
+    address.program = item->data( ROLE_PROGRAM ).toInt();
+    return address;
+}
+
+//Set program change address of an entry, shown as tooltip of the name
+void MainWindow::setRowAddress( int row, const ProgramAddress &address )
+{
+    QTableWidgetItem *item = ui->tableWidget->item( row, 0 );
+    if( !item ) return;
+    if( address.isDefault() )
+    {
+        item->setData( ROLE_CHANNEL, QVariant() );
+        item->setData( ROLE_BANK, QVariant() );
+        item->setData( ROLE_PROGRAM, QVariant() );
+        item->setToolTip( QString() );
+        return;
+    }
+    item->setData( ROLE_CHANNEL, address.channel );
+    item->setData( ROLE_BANK, address.bank );
+    item->setData( ROLE_PROGRAM, address.program );
+    item->setToolTip( tr( "Channel %1, Bank %2, Program %3" )
+                      .arg( address.channel > 0 ? QString::number( address.channel ) : tr( "any" ) )
+                      .arg( address.bank >= 0 ? QString::number( address.bank ) : tr( "any" ) )
+                      .arg( address.program >= 0 ? QString::number( address.program ) : tr( "entry number" ) ) );
+}
+
+//Rebuild the lookup table for incoming program changes
+void MainWindow::updateProgramMap( void )
+{
+    QVector<ProgramAddress> addresses( ui->tableWidget->rowCount() );
+    for( int row = 0; row < addresses.size(); row++ ) addresses[row] = rowAddress( row );
+    m_programMap.build( addresses );
+}
+
+//Give the fast path a job for every entry, the MIDI thread can not look into the table
+void MainWindow::updateFastPathJobs( void )
+{
+    QVector<SendJob> jobs;
+    if( m_fastPath->isEnabled() )
+    {
+        jobs.resize( ui->tableWidget->rowCount() );
+        for( int row = 0; row < jobs.size(); row++ )
         {
-            m_midiOut->openPort( ui->comboBoxSynth4->currentIndex() );
-            std::vector<unsigned char> message( syxData.begin(), syxData.end() );
-            m_midiOut->sendRawMessage( message );
-            m_midiOut->closePort();
+            QStringList fileNames = rowFileNames( row );
+            jobs[row].row = row;
+            for( int i = 0; i < SYNTH_SLOTS; i++ )
+            {
+                if( fileNames.at( i ).isEmpty() ) continue;
+                if( !m_patchCache->contains( fileNames.at( i ) ) ) m_patchCache->addFile( fileNames.at( i ) );
+                jobs[row].patches[i] = m_patchCache->patch( fileNames.at( i ) );
+            }
         }
     }
+    m_fastPath->setJobs( jobs, m_programMap );
+}
+
+//One synth has received its patch
+void MainWindow::onPortFinished( int slot )
+{
+    statusBar()->showMessage( tr( "Synth %1 done." ).arg( slot + 1 ), 0 );
+}
+
+//A synth port could not be opened, e.g. the device is busy or gone
+void MainWindow::onPortError( int slot, const QString &message )
+{
+    statusBar()->showMessage( tr( "Synth %1: %2" ).arg( slot + 1 ).arg( message ), 5000 );
+}
+
+//Sending progress
+void MainWindow::onJobProgress( int jobId, int percent )
+{
+    Q_UNUSED( jobId );
+    statusBar()->showMessage( tr( "Sending patches... %1%" ).arg( percent ), 0 );
+}
+
+//All synths have received their patches, or sending was cancelled
+void MainWindow::onJobFinished( int jobId, bool cancelled )
+{
+    Q_UNUSED( jobId );
+    if( cancelled ) statusBar()->showMessage( tr( "Sending cancelled." ), 3000 );
+    else statusBar()->showMessage( tr( "Patches sent." ), 3000 );
 }
 
 //Delete table
@@ -323,6 +542,9 @@ void MainWindow::on_actionNew_triggered()
         ui->tableWidget->removeRow( 0 );
     }
     ui->plainTextEdit->setEnabled( false );
+    m_sendEngine->cancel();
+    m_prefetcher->clear();
+    m_patchCache->clear();
 }
 
 //Open table
@@ -408,6 +630,16 @@ void MainWindow::loadFile(const QString & fileName)
                         ui->tableWidget->item( ui->tableWidget->rowCount()-1, 0 )->setText( Rxml.attributes().at(0).value().toString() );
                     }
 
+                    //Read program change address, if there is one
+                    if( Rxml.attributes().hasAttribute( "channel" ) )
+                    {
+                        ProgramAddress address;
+                        address.channel = Rxml.attributes().value( "channel" ).toString().toInt();
+                        address.bank = Rxml.attributes().value( "bank" ).toString().toInt();
+                        address.program = Rxml.attributes().value( "program" ).toString().toInt();
+                        setRowAddress( ui->tableWidget->rowCount()-1, address );
+                    }
+
                     while( !Rxml.atEnd() && !Rxml.isEndElement() )
                     {
                         Rxml.readNext();
@@ -416,6 +648,7 @@ void MainWindow::loadFile(const QString & fileName)
                             QString fileName = Rxml.readElementText();
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 1 )->setText( fileName );
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 5 )->setText( QFileInfo( fileName ).fileName() );
+                            m_patchCache->addFile( fileName );
                             Rxml.readNext();
                         }
                         else if( Rxml.isStartElement() && Rxml.name() == "synth2" )
@@ -423,6 +656,7 @@ void MainWindow::loadFile(const QString & fileName)
                             QString fileName = Rxml.readElementText();
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 2 )->setText( fileName );
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 6 )->setText( QFileInfo( fileName ).fileName() );
+                            m_patchCache->addFile( fileName );
                             Rxml.readNext();
                         }
                         else if( ui->action4Synths->isChecked() && Rxml.isStartElement() && Rxml.name() == "synth3" )
@@ -430,6 +664,7 @@ void MainWindow::loadFile(const QString & fileName)
                             QString fileName = Rxml.readElementText();
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 3 )->setText( fileName );
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 7 )->setText( QFileInfo( fileName ).fileName() );
+                            m_patchCache->addFile( fileName );
                             Rxml.readNext();
                         }
                         else if( ui->action4Synths->isChecked() && Rxml.isStartElement() && Rxml.name() == "synth4" )
@@ -437,6 +672,7 @@ void MainWindow::loadFile(const QString & fileName)
                             QString fileName = Rxml.readElementText();
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 4 )->setText( fileName );
                             ui->tableWidget->item( ui->tableWidget->rowCount()-1, 8 )->setText( QFileInfo( fileName ).fileName() );
+                            m_patchCache->addFile( fileName );
                             Rxml.readNext();
                         }
                         else if( Rxml.isStartElement() && Rxml.name() == "info" )
@@ -463,6 +699,7 @@ void MainWindow::loadFile(const QString & fileName)
     }
 
     file.close();
+    resetPrefetch();
 }
 
 //Save table
@@ -500,6 +737,13 @@ void MainWindow::on_actionSave_triggered()
     {
         xmlWriter.writeStartElement( "song" );
         xmlWriter.writeAttribute( "name", ui->tableWidget->item(i, 0)->text() );
+        ProgramAddress address = rowAddress( i );
+        if( !address.isDefault() )
+        {
+            xmlWriter.writeAttribute( "channel", QString::number( address.channel ) );
+            xmlWriter.writeAttribute( "bank", QString::number( address.bank ) );
+            xmlWriter.writeAttribute( "program", QString::number( address.program ) );
+        }
         xmlWriter.writeTextElement( "synth1", ui->tableWidget->item(i, 1)->text() );
         xmlWriter.writeTextElement( "synth2", ui->tableWidget->item(i, 2)->text() );
         if( ui->action4Synths->isChecked() )
@@ -527,24 +771,28 @@ void MainWindow::on_comboBoxInput_activated(const QString &arg1)
 void MainWindow::on_comboBoxSynth1_activated(const QString &arg1)
 {
     m_synth1 = arg1;
+    m_sendEngine->setPortName( 0, arg1 );
 }
 
 //Actively changed port 2
 void MainWindow::on_comboBoxSynth2_activated(const QString &arg1)
 {
     m_synth2 = arg1;
+    m_sendEngine->setPortName( 1, arg1 );
 }
 
 //Actively changed port 3
 void MainWindow::on_comboBoxSynth3_activated(const QString &arg1)
 {
     m_synth3 = arg1;
+    m_sendEngine->setPortName( 2, arg1 );
 }
 
 //Actively changed port 4
 void MainWindow::on_comboBoxSynth4_activated(const QString &arg1)
 {
     m_synth4 = arg1;
+    m_sendEngine->setPortName( 3, arg1 );
 }
 
 //Move row up
@@ -576,6 +824,7 @@ void MainWindow::moveRow(bool up)
     setRow(destRow, sourceItems);
 
     ui->tableWidget->setCurrentCell( destRow, ui->tableWidget->currentColumn() );
+    resetPrefetch();
 }
 
 //Read registry settings
@@ -589,6 +838,22 @@ void MainWindow::readSettings()
     QFont font = ui->plainTextEdit->font();
     font.setPointSize( set.value( "fontSize", font.pointSize() ).toInt() );
     ui->plainTextEdit->setFont( font );
+    m_coalescer->setSettleWindow( set.value( "settleWindow", 0 ).toInt() );
+    ui->actionDeltaSend->setChecked( set.value( "deltaSend", false ).toBool() );
+    m_sendEngine->setDeltaMode( ui->actionDeltaSend->isChecked() );
+    ui->actionFastProgramChange->setChecked( set.value( "fastProgramChange", false ).toBool() );
+    m_additionalInputs = set.value( "additionalInputs" ).toStringList();
+    m_realtimePriority = set.value( "realtimePriority", 0 ).toInt();
+    m_realtimeCpu = set.value( "realtimeCpu", -1 ).toInt();
+    m_patchCache->setLocked( set.value( "lockPatches", false ).toBool() );
+    applyRealtime();
+    m_fastPath->setEnabled( ui->actionFastProgramChange->isChecked() );
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        m_pacingDelay[i] = set.value( QString( "pacingDelay%1" ).arg( i + 1 ), 0 ).toInt();
+        m_pacingRate[i] = set.value( QString( "pacingRate%1" ).arg( i + 1 ), 0 ).toInt();
+        m_sendEngine->setPacing( i, m_pacingDelay[i], m_pacingRate[i] );
+    }
     if( set.value( "4Synths", false ).toBool() )
     {
         ui->action4Synths->setChecked( true );
@@ -611,6 +876,18 @@ void MainWindow::writeSettings()
     set.setValue( "recentFiles", m_recentFilesMenu->saveState() );
     set.setValue( "fontSize", ui->plainTextEdit->font().pointSize() );
     set.setValue( "4Synths", ui->action4Synths->isChecked() );
+    set.setValue( "settleWindow", m_coalescer->settleWindow() );
+    set.setValue( "deltaSend", ui->actionDeltaSend->isChecked() );
+    set.setValue( "realtimePriority", m_realtimePriority );
+    set.setValue( "realtimeCpu", m_realtimeCpu );
+    set.setValue( "lockPatches", m_patchCache->isLocked() );
+    set.setValue( "fastProgramChange", ui->actionFastProgramChange->isChecked() );
+    set.setValue( "additionalInputs", m_additionalInputs );
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        set.setValue( QString( "pacingDelay%1" ).arg( i + 1 ), m_pacingDelay[i] );
+        set.setValue( QString( "pacingRate%1" ).arg( i + 1 ), m_pacingRate[i] );
+    }
 }
 
 //Take row (for move)
@@ -665,6 +942,7 @@ void MainWindow::on_tableWidget_currentCellChanged(int currentRow, int currentCo
         ui->plainTextEdit->setPlainText( ui->tableWidget->item( currentRow, 9 )->text() );
         ui->plainTextEdit->blockSignals( false );
         ui->plainTextEdit->setEnabled( true );
+        prefetchAround( currentRow );
     }
 }
 
@@ -689,34 +967,158 @@ void MainWindow::on_pushButtonListen_toggled(bool checked)
 {
     if( checked )
     {
-        m_midiIn->openPort( ui->comboBoxInput->currentIndex() );
-        connect(m_midiIn, SIGNAL(midiMessageReceived(QMidiMessage*)), this, SLOT(onMidiMessageReceive(QMidiMessage*)));
+        //By name: the combo index may be outdated after a hotplug, the name is checked against the driver
+        m_midiIn->openPort( ui->comboBoxInput->currentText() );
+        //Further controllers share the connection and MIDI thread of the main input
+        foreach( QString port, m_additionalInputs )
+        {
+            if( port != ui->comboBoxInput->currentText() ) m_midiIn->addPort( port );
+        }
+        connect(m_midiIn, SIGNAL(midiEventReceived(QMidiEvent)), this, SLOT(onMidiEventReceive(QMidiEvent)));
         //qDebug() << "Port opened";
+        if( m_realtimePriority > 0 && m_midiIn->isPortOpen() && !m_midiIn->isRealtime() )
+        {
+            statusBar()->showMessage( tr( "Real-time priority not permitted, listening with normal priority." ), 5000 );
+        }
     }
     else
     {
-        disconnect(m_midiIn, SIGNAL(midiMessageReceived(QMidiMessage*)), this, SLOT(onMidiMessageReceive(QMidiMessage*)));
+        disconnect(m_midiIn, SIGNAL(midiEventReceived(QMidiEvent)), this, SLOT(onMidiEventReceive(QMidiEvent)));
         m_midiIn->closePort();
         //qDebug() << "Port closed";
     }
 }
 
 //Get the midi message
-void MainWindow::onMidiMessageReceive(QMidiMessage *message)
+void MainWindow::onMidiEventReceive(QMidiEvent event)
 {
-    unsigned int statusType = (message->getStatus());
-    unsigned int programNumber = message->getValue();
-    int theRowCount = ui->tableWidget->rowCount();
+    unsigned int statusType = (event.getStatus());
+    int channel = (int)event.getChannel();
+
+    //Remember bank select per channel for the next program change
+    if( statusType == MIDI_CONTROL_CHANGE )
+    {
+        m_bankSelect.controlChange( channel, (int)event.getControl(), (int)event.getValue() );
+        return;
+    }
 
     //If program change, select row and send settings
-    if( statusType == 192 )
+    if( statusType == MIDI_PROGRAM_CHANGE )
     {
-        qDebug() << "Received Program Change on MIDI Channel " << message->getChannel() << programNumber << statusType;
-        if( (int)programNumber < theRowCount )
+        unsigned int programNumber = event.getValue();
+        int row = m_programMap.lookup( channel, m_bankSelect.bank( channel ), (int)programNumber );
+
+        LatencyStats *latencyStats = m_sendEngine->latencyStats();
+        latencyStats->record( LatencyReceive, event.getEmitTimestamp() - event.getTimestamp() );
+
+        //Fast path has started sending already, just follow in the table
+        if( event.isHandled() )
         {
-            ui->tableWidget->selectRow( programNumber );
-            on_actionSendPatches_triggered();
+            ui->tableWidget->selectRow( row );
+            return;
         }
+        m_settleStart = latencyStats->recordSince( LatencyDispatch, event.getEmitTimestamp() );
+
+        qDebug() << "Received Program Change from" << m_midiIn->sourceName( event.getSource() ) << "on MIDI Channel " << channel << m_bankSelect.bank( channel ) << programNumber;
+        if( row >= 0 && row < ui->tableWidget->rowCount() )
+        {
+            ui->tableWidget->selectRow( row );
+            m_requestTimestamp = event.getTimestamp();
+            m_coalescer->request( row );
+        }
+    }
+}
+
+//Set time to wait for further program changes before sending
+void MainWindow::on_actionSettleWindow_triggered()
+{
+    bool ok;
+    int ms = QInputDialog::getInt( this, APPNAME,
+                                   tr( "Wait for further program changes before sending (ms):" ),
+                                   m_coalescer->settleWindow(), 0, 5000, 10, &ok );
+    if( ok ) m_coalescer->setSettleWindow( ms );
+}
+
+//Set gaps and data rates for sending sysex to each synth
+void MainWindow::on_actionPacing_triggered()
+{
+    PacingDialog dialog( ui->action4Synths->isChecked() ? 4 : 2, this );
+    for( int i = 0; i < SYNTH_SLOTS; i++ ) dialog.setPacing( i, m_pacingDelay[i], m_pacingRate[i] );
+    if( dialog.exec() != QDialog::Accepted ) return;
+
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        m_pacingDelay[i] = dialog.delay( i );
+        m_pacingRate[i] = dialog.bytesPerSecond( i );
+        m_sendEngine->setPacing( i, m_pacingDelay[i], m_pacingRate[i] );
+    }
+}
+
+//Scheduling of the MIDI threads and memory locking of the patches
+void MainWindow::on_actionRealtime_triggered()
+{
+    RealtimeDialog dialog( this );
+    dialog.setSettings( m_realtimePriority, m_realtimeCpu, m_patchCache->isLocked() );
+    if( dialog.exec() != QDialog::Accepted ) return;
+
+    m_realtimePriority = dialog.priority();
+    m_realtimeCpu = dialog.cpu();
+    applyRealtime();
+    if( !m_patchCache->setLocked( dialog.lockPatches() ) )
+    {
+        statusBar()->showMessage( tr( "Not all patches fit into the memlock limit, the rest may be swapped out." ), 5000 );
+    }
+}
+
+//Hand the scheduling settings to the MIDI threads. The input thread gets them when listening starts.
+void MainWindow::applyRealtime()
+{
+    m_midiIn->setRealtime( m_realtimePriority, m_realtimeCpu );
+    //Senders one step below, a long dump must never delay the next program change. Priority 1 leaves them at normal scheduling.
+    m_sendEngine->setRealtime( m_realtimePriority > 1 ? m_realtimePriority - 1 : 0 );
+}
+
+//Send only changed sysex messages
+void MainWindow::on_actionDeltaSend_triggered( bool checked )
+{
+    m_sendEngine->setDeltaMode( checked );
+}
+
+//Show where the time between program change and synth goes
+void MainWindow::on_actionLatencyStats_triggered()
+{
+    LatencyDialog dialog( m_sendEngine->latencyStats(), m_midiIn, this );
+    dialog.exec();
+}
+
+//Send patches from the MIDI thread, without waiting for the GUI
+void MainWindow::on_actionFastProgramChange_triggered( bool checked )
+{
+    m_fastPath->setEnabled( checked );
+    updateFastPathJobs();
+}
+
+//Switch between ALSA sequencer and rawmidi, used after the next start
+void MainWindow::on_actionRawMidi_triggered( bool checked )
+{
+    QSettings set( QSettings::UserScope, "masc.SysexLive", "SysexLive" );
+    set.setValue( "rawMidi", checked );
+    QMessageBox::information( this, APPNAME,
+                              tr( "The MIDI transport changes after restarting %1. Interfaces get other names then, please select them again." ).arg( APPNAME ) );
+}
+
+//Save the recent MIDI traffic, decode it with QMidi/tools/tracedump
+void MainWindow::on_actionDumpMidiTrace_triggered()
+{
+    QString path = QFileInfo( m_lastSaveFileName ).absolutePath();
+    QString fileName = QFileDialog::getSaveFileName( this, tr( "Dump MIDI Trace" ), path,
+                                                     tr( "MIDI trace (*.qmtr)" ) );
+    if( fileName.isEmpty() ) return;
+    if( !fileName.endsWith( ".qmtr", Qt::CaseInsensitive ) ) fileName.append( ".qmtr" );
+
+    if( !QMidiTrace::dump( fileName ) )
+    {
+        QMessageBox::critical( this, APPNAME, tr( "Could not write %1." ).arg( fileName ) );
     }
 }
 
@@ -729,6 +1131,8 @@ void MainWindow::on_action2Synths_triggered()
     ui->labelSynth4->setVisible( false );
     ui->tableWidget->hideColumn( 7 );
     ui->tableWidget->hideColumn( 8 );
+    connectSynthPorts();
+    resetPrefetch();
 }
 
 //Config GUI for 4 synths
@@ -740,6 +1144,8 @@ void MainWindow::on_action4Synths_triggered()
     ui->labelSynth4->setVisible( true );
     ui->tableWidget->showColumn( 7 );
     ui->tableWidget->showColumn( 8 );
+    connectSynthPorts();
+    resetPrefetch();
 }
 
 //Context menu for table
@@ -756,9 +1162,42 @@ void MainWindow::on_tableWidget_customContextMenuRequested(const QPoint &pos)
     myMenu.addSeparator();
     myMenu.addAction( ui->actionMoveUp );
     myMenu.addAction( ui->actionMoveDown );
+    myMenu.addAction( ui->actionProgramAddress );
     myMenu.addSeparator();
     myMenu.addAction( ui->actionDeleteEntry );
 
     // Show context menu at handling position
     myMenu.exec( globalPos );
 }
+
+//Set channel, bank and program which select the current entry
+void MainWindow::on_actionProgramAddress_triggered()
+{
+    int row = ui->tableWidget->currentRow();
+    if( row < 0 ) return;
+    ProgramAddressDialog dialog( this );
+    dialog.setAddress( rowAddress( row ) );
+    if( dialog.exec() != QDialog::Accepted ) return;
+    setRowAddress( row, dialog.address() );
+    updateProgramMap();
+    updateFastPathJobs();
+}
+
+//Select controllers listened to in addition to the main input
+void MainWindow::on_actionAdditionalInputs_triggered()
+{
+    QStringList ports;
+    for( int i = 0; i < ui->comboBoxInput->count(); i++ ) ports.append( ui->comboBoxInput->itemText( i ) );
+
+    InputPortsDialog dialog( this );
+    dialog.setPorts( ports, m_additionalInputs );
+    if( dialog.exec() != QDialog::Accepted ) return;
+    m_additionalInputs = dialog.checkedPorts();
+
+    //Reconnect if listening, so removed ports are dropped as well
+    if( ui->pushButtonListen->isChecked() )
+    {
+        on_pushButtonListen_toggled( false );
+        on_pushButtonListen_toggled( true );
+    }
+}
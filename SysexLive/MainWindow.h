@@ -12,9 +12,17 @@
 #include "qmidiin.h"
 #include "qmidiout.h"
 #include "qmidimapper.h"
+#include "qmidiportregistry.h"
 #include <QTableWidget>
+#include <QTimer>
 #include <QRecentFilesMenu.h>
 #include "EventReturnFilter.h"
+#include "PatchCache.h"
+#include "SendEngine.h"
+#include "ProgramChangeCoalescer.h"
+#include "Prefetcher.h"
+#include "ProgramChangeFastPath.h"
+#include "ProgramMap.h"
 
 namespace Ui {
 class MainWindow;
@@ -52,30 +60,70 @@ private slots:
     void on_actionZoomTextPlus_triggered();
     void on_actionZoomTextMinus_triggered();
     void on_pushButtonListen_toggled(bool checked);
-    void onMidiMessageReceive(QMidiMessage *message);
+    void onMidiEventReceive(QMidiEvent event);
     void on_action2Synths_triggered();
     void on_action4Synths_triggered();
     void on_tableWidget_customContextMenuRequested(const QPoint &pos);
+    void onPortsChanged(void);
+    void onPortFinished(int slot);
+    void onPortError(int slot, const QString &message);
+    void onJobProgress(int jobId, int percent);
+    void onJobFinished(int jobId, bool cancelled);
+    void sendRow(int row);
+    void on_actionSettleWindow_triggered();
+    void on_actionPacing_triggered();
+    void on_actionDeltaSend_triggered(bool checked);
+    void on_actionLatencyStats_triggered();
+    void on_actionDumpMidiTrace_triggered();
+    void on_actionFastProgramChange_triggered(bool checked);
+    void updateFastPathJobs(void);
+    void on_actionProgramAddress_triggered();
+    void on_actionAdditionalInputs_triggered();
+    void on_actionRawMidi_triggered(bool checked);
+    void on_actionRealtime_triggered();
 
 private:
     Ui::MainWindow *ui;
     void getPorts(void);
+    void updatePortAvailability(void);
     void searchSynths(void);
+    void connectSynthPorts(void);
+    QStringList rowFileNames(int row);
+    void prefetchAround(int row);
+    void resetPrefetch(void);
+    ProgramAddress rowAddress(int row);
+    void setRowAddress(int row, const ProgramAddress &address);
+    void updateProgramMap(void);
     void moveRow( bool up );
     void readSettings(void);
     void writeSettings(void);
+    void applyRealtime(void);
     QList<QTableWidgetItem*>  takeRow( int row );
     void setRow(int row, const QList<QTableWidgetItem *> &rowItems);
 
     QRecentFilesMenu *m_recentFilesMenu;
     QString m_lastSaveFileName;
     QString m_midiInput;
+    QStringList m_additionalInputs;
     QString m_synth1;
     QString m_synth2;
     QString m_synth3;
     QString m_synth4;
     QMidiIn *m_midiIn;
-    QMidiOut *m_midiOut;
+    PatchCache *m_patchCache;
+    Prefetcher *m_prefetcher;
+    SendEngine *m_sendEngine;
+    ProgramChangeCoalescer *m_coalescer;
+    ProgramChangeFastPath *m_fastPath;
+    ProgramMap m_programMap;
+    BankSelect m_bankSelect;
+    int m_pacingDelay[SYNTH_SLOTS];
+    int m_pacingRate[SYNTH_SLOTS];
+    int m_realtimePriority;
+    int m_realtimeCpu;
+    qint64 m_requestTimestamp;
+    qint64 m_settleStart;
+    QMidiPortRegistry *m_portRegistry;
     EventReturnFilter *m_eventFilter;
     QActionGroup *m_actionGroupSynths;
 };
@@ -0,0 +1,66 @@
+/*!
+ * \file PacingDialog.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the per synth sysex pacing settings
+ */
+
+#include "PacingDialog.h"
+#include <QGridLayout>
+#include <QLabel>
+#include <QDialogButtonBox>
+
+//Constructor
+PacingDialog::PacingDialog( int synths, QWidget *parent )
+    : QDialog( parent )
+{
+    setWindowTitle( tr( "Sysex Pacing" ) );
+
+    QGridLayout *layout = new QGridLayout( this );
+    layout->addWidget( new QLabel( tr( "Gap after message (ms)" ) ), 0, 1 );
+    layout->addWidget( new QLabel( tr( "Max. bytes/s (0 = unlimited)" ) ), 0, 2 );
+
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        m_delay[i] = new QSpinBox( this );
+        m_delay[i]->setRange( 0, 1000 );
+        m_rate[i] = new QSpinBox( this );
+        m_rate[i]->setRange( 0, 1000000 );
+        m_rate[i]->setSingleStep( 100 );
+
+        //Synth 3 & 4 only if 4 synths are configured
+        if( i >= synths ) continue;
+        layout->addWidget( new QLabel( tr( "Synth %1" ).arg( i + 1 ) ), i + 1, 0 );
+        layout->addWidget( m_delay[i], i + 1, 1 );
+        layout->addWidget( m_rate[i], i + 1, 2 );
+    }
+    for( int i = synths; i < SYNTH_SLOTS; i++ )
+    {
+        m_delay[i]->hide();
+        m_rate[i]->hide();
+    }
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, this );
+    connect( buttonBox, SIGNAL(accepted()), this, SLOT(accept()) );
+    connect( buttonBox, SIGNAL(rejected()), this, SLOT(reject()) );
+    layout->addWidget( buttonBox, SYNTH_SLOTS + 1, 0, 1, 3 );
+}
+
+//Preset values of a slot
+void PacingDialog::setPacing( int slot, int delayMs, int bytesPerSecond )
+{
+    m_delay[slot]->setValue( delayMs );
+    m_rate[slot]->setValue( bytesPerSecond );
+}
+
+//Gap after each message in ms
+int PacingDialog::delay( int slot ) const
+{
+    return m_delay[slot]->value();
+}
+
+//Data rate ceiling in bytes per second
+int PacingDialog::bytesPerSecond( int slot ) const
+{
+    return m_rate[slot]->value();
+}
@@ -0,0 +1,29 @@
+/*!
+ * \file PacingDialog.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the per synth sysex pacing settings
+ */
+
+#ifndef PACINGDIALOG_H
+#define PACINGDIALOG_H
+
+#include <QDialog>
+#include <QSpinBox>
+#include "SendEngine.h"
+
+class PacingDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit PacingDialog( int synths, QWidget *parent = 0 );
+    void setPacing( int slot, int delayMs, int bytesPerSecond );
+    int delay( int slot ) const;
+    int bytesPerSecond( int slot ) const;
+
+private:
+    QSpinBox *m_delay[SYNTH_SLOTS];
+    QSpinBox *m_rate[SYNTH_SLOTS];
+};
+
+#endif // PACINGDIALOG_H
@@ -0,0 +1,152 @@
+/*!
+ * \file PatchCache.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief In-memory cache for all sysex files of a setlist
+ */
+
+#include "PatchCache.h"
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+//Constructor
+PatchCache::PatchCache( QObject *parent )
+    : QObject( parent )
+    , m_locked( false )
+{
+    m_watcher = new QFileSystemWatcher( this );
+    connect( m_watcher, SIGNAL(fileChanged(const QString &)), this, SLOT(onFileChanged(const QString &)) );
+}
+
+//Destructor
+PatchCache::~PatchCache()
+{
+    clear();
+}
+
+//Read a file into the cache and watch it for changes
+void PatchCache::addFile( const QString &fileName )
+{
+    if( fileName.isEmpty() ) return;
+    if( m_patches.contains( fileName ) ) return;
+
+    if( readFile( fileName ) && !m_watcher->files().contains( fileName ) )
+    {
+        m_watcher->addPath( fileName );
+    }
+}
+
+//Get a cached patch, never touches the file system
+SysexPatchPtr PatchCache::patch( const QString &fileName ) const
+{
+    return m_patches.value( fileName );
+}
+
+//Is the file in the cache?
+bool PatchCache::contains( const QString &fileName ) const
+{
+    return m_patches.contains( fileName );
+}
+
+//Drop all patches
+void PatchCache::clear( void )
+{
+    if( !m_watcher->files().isEmpty() ) m_watcher->removePaths( m_watcher->files() );
+    m_patches.clear();
+}
+
+//Keep all patches in RAM, so sending never waits for a page fault. Returns false if the memlock limit does not allow all of them.
+bool PatchCache::setLocked( bool locked )
+{
+    m_locked = locked;
+    bool allLocked = true;
+    foreach( SysexPatchPtr patch, m_patches )
+    {
+        if( !locked ) patch->unlock();
+        else if( !patch->lock() ) allLocked = false;
+    }
+    return allLocked;
+}
+
+//Are patches locked into RAM?
+bool PatchCache::isLocked( void ) const
+{
+    return m_locked;
+}
+
+//A watched file was modified, replaced or deleted
+void PatchCache::onFileChanged( const QString &fileName )
+{
+    //Invalidate old data, patches in use by a sender stay alive until it is done
+    m_patches.remove( fileName );
+
+    //Editors often replace the file, then the watcher forgets it
+    if( readFile( fileName ) && !m_watcher->files().contains( fileName ) )
+    {
+        m_watcher->addPath( fileName );
+    }
+    emit patchChanged( fileName );
+}
+
+//Load file content into a send-ready buffer
+bool PatchCache::readFile( const QString &fileName )
+{
+    SysexPatchPtr patch( new SysexPatch );
+    if( !patch->load( fileName ) ) return false;
+    //Best effort, an unlocked patch is sent anyway
+    if( m_locked ) patch->lock();
+    m_patches.insert( fileName, patch );
+    return true;
+}
+
+//Constructor
+SysexPatch::SysexPatch()
+    : data( 0 )
+    , size( 0 )
+    , m_locked( false )
+{
+}
+
+//Destructor
+SysexPatch::~SysexPatch()
+{
+    unlock();
+}
+
+//Read the file into an own buffer and index its messages. Edits of the file never touch a loaded patch,
+//the cache loads a new one when the watcher reports the change.
+bool SysexPatch::load( const QString &fileName )
+{
+    this->fileName = fileName;
+    QFile file( fileName );
+    if( !file.exists() ) return false;
+    if( !file.open( QIODevice::ReadOnly ) ) return false;
+
+    m_buffer = file.readAll();
+    file.close();
+    data = (const unsigned char*)m_buffer.constData();
+    size = (size_t)m_buffer.size();
+    if( size > 0 ) SysexSplitter::split( data, size, messages );
+    return true;
+}
+
+//Load all pages now and keep them in RAM. Fails if the memlock limit (ulimit -l) is too small.
+bool SysexPatch::lock( void )
+{
+    if( m_locked || !data || size == 0 ) return true;
+#ifdef Q_OS_UNIX
+    m_locked = ( mlock( data, size ) == 0 );
+#endif
+    return m_locked;
+}
+
+//Allow the pages to be swapped out again
+void SysexPatch::unlock( void )
+{
+    if( !m_locked ) return;
+#ifdef Q_OS_UNIX
+    munlock( data, size );
+#endif
+    m_locked = false;
+}
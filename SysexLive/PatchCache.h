@@ -0,0 +1,73 @@
+/*!
+ * \file PatchCache.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief In-memory cache for all sysex files of a setlist
+ */
+
+#ifndef PATCHCACHE_H
+#define PATCHCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QSharedPointer>
+#include <QMetaType>
+#include <QFileSystemWatcher>
+#include <QFile>
+#include <QByteArray>
+#include <vector>
+#include "SysexSplitter.h"
+
+//One sysex file, ready to be sent. The file is read once and closed, data points into the own buffer and never changes.
+class SysexPatch
+{
+public:
+    SysexPatch();
+    ~SysexPatch();
+    bool load( const QString &fileName );
+    bool lock( void );
+    void unlock( void );
+
+    QString fileName;
+    const unsigned char *data;
+    size_t size;
+    std::vector<SysexMessage> messages;
+
+private:
+    QByteArray m_buffer;
+    bool m_locked;
+    Q_DISABLE_COPY( SysexPatch )
+};
+
+typedef QSharedPointer<SysexPatch> SysexPatchPtr;
+Q_DECLARE_METATYPE( SysexPatchPtr )
+
+class PatchCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PatchCache( QObject *parent = 0 );
+    ~PatchCache();
+    void addFile( const QString &fileName );
+    SysexPatchPtr patch( const QString &fileName ) const;
+    bool contains( const QString &fileName ) const;
+    void clear( void );
+    bool setLocked( bool locked );
+    bool isLocked( void ) const;
+
+signals:
+    void patchChanged( const QString &fileName );
+
+private slots:
+    void onFileChanged( const QString &fileName );
+
+private:
+    bool readFile( const QString &fileName );
+
+    QHash<QString, SysexPatchPtr> m_patches;
+    QFileSystemWatcher *m_watcher;
+    bool m_locked;
+};
+
+#endif // PATCHCACHE_H
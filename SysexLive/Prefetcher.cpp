@@ -0,0 +1,72 @@
+/*!
+ * \file Prefetcher.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Keeps ready to send jobs for the setlist entries around the current one
+ */
+
+#include "Prefetcher.h"
+
+//Constructor
+Prefetcher::Prefetcher( PatchCache *patchCache, QObject *parent )
+    : QObject( parent )
+    , m_patchCache( patchCache )
+{
+    //Reloaded files make prepared jobs outdated
+    connect( m_patchCache, SIGNAL(patchChanged(const QString &)), this, SLOT(clear()) );
+}
+
+//Build the job for a setlist entry, fileNames are the files for synth 1..4 (empty = not used)
+void Prefetcher::prepare( int row, const QStringList &fileNames )
+{
+    if( m_jobs.contains( row ) ) return;
+
+    SendJob job;
+    job.row = row;
+    for( int i = 0; i < SYNTH_SLOTS && i < fileNames.count(); i++ )
+    {
+        if( fileNames.at( i ).isEmpty() ) continue;
+
+        //File may have been missing when the setlist was loaded (e.g. drive not mounted)
+        if( !m_patchCache->contains( fileNames.at( i ) ) ) m_patchCache->addFile( fileNames.at( i ) );
+
+        job.patches[i] = m_patchCache->patch( fileNames.at( i ) );
+        touch( job.patches[i] );
+    }
+    m_jobs.insert( row, job );
+}
+
+//Get a prepared job
+bool Prefetcher::job( int row, SendJob &job ) const
+{
+    QHash<int, SendJob>::const_iterator it = m_jobs.constFind( row );
+    if( it == m_jobs.constEnd() ) return false;
+    job = it.value();
+    return true;
+}
+
+//Forget jobs far away from the current entry
+void Prefetcher::keepRange( int currentRow )
+{
+    QHash<int, SendJob>::iterator it = m_jobs.begin();
+    while( it != m_jobs.end() )
+    {
+        if( qAbs( it.key() - currentRow ) > PREFETCH_RANGE ) it = m_jobs.erase( it );
+        else ++it;
+    }
+}
+
+//Forget all jobs, e.g. after the setlist was edited
+void Prefetcher::clear( void )
+{
+    m_jobs.clear();
+}
+
+//Read every memory page once, so the send path does not run into page faults
+void Prefetcher::touch( const SysexPatchPtr &patch )
+{
+    if( patch.isNull() || patch->size == 0 ) return;
+    volatile unsigned char sum = 0;
+    for( size_t i = 0; i < patch->size; i += 4096 ) sum += patch->data[i];
+    (void)sum;
+}
@@ -0,0 +1,39 @@
+/*!
+ * \file Prefetcher.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Keeps ready to send jobs for the setlist entries around the current one
+ */
+
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include "PatchCache.h"
+#include "SendEngine.h"
+
+//Number of entries before and after the current one which are kept ready
+#define PREFETCH_RANGE 2
+
+class Prefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Prefetcher( PatchCache *patchCache, QObject *parent = 0 );
+    void prepare( int row, const QStringList &fileNames );
+    bool job( int row, SendJob &job ) const;
+    void keepRange( int currentRow );
+
+public slots:
+    void clear( void );
+
+private:
+    void touch( const SysexPatchPtr &patch );
+
+    PatchCache *m_patchCache;
+    QHash<int, SendJob> m_jobs;
+};
+
+#endif // PREFETCHER_H
@@ -0,0 +1,60 @@
+/*!
+ * \file ProgramAddressDialog.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the channel, bank and program which select a setlist entry
+ */
+
+#include "ProgramAddressDialog.h"
+#include <QGridLayout>
+#include <QLabel>
+#include <QDialogButtonBox>
+
+//Constructor
+ProgramAddressDialog::ProgramAddressDialog( QWidget *parent )
+    : QDialog( parent )
+{
+    setWindowTitle( tr( "Program Change Address" ) );
+
+    //The lowest value of each box means "not set"
+    m_channel = new QSpinBox( this );
+    m_channel->setRange( 0, 16 );
+    m_channel->setSpecialValueText( tr( "Any" ) );
+    m_bank = new QSpinBox( this );
+    m_bank->setRange( -1, PROGRAM_MAP_BANKS - 1 );
+    m_bank->setSpecialValueText( tr( "Any" ) );
+    m_program = new QSpinBox( this );
+    m_program->setRange( -1, PROGRAM_MAP_PROGRAMS - 1 );
+    m_program->setSpecialValueText( tr( "Entry number" ) );
+
+    QGridLayout *layout = new QGridLayout( this );
+    layout->addWidget( new QLabel( tr( "MIDI channel" ) ), 0, 0 );
+    layout->addWidget( m_channel, 0, 1 );
+    layout->addWidget( new QLabel( tr( "Bank (CC0 * 128 + CC32)" ) ), 1, 0 );
+    layout->addWidget( m_bank, 1, 1 );
+    layout->addWidget( new QLabel( tr( "Program (0-127)" ) ), 2, 0 );
+    layout->addWidget( m_program, 2, 1 );
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, this );
+    connect( buttonBox, SIGNAL(accepted()), this, SLOT(accept()) );
+    connect( buttonBox, SIGNAL(rejected()), this, SLOT(reject()) );
+    layout->addWidget( buttonBox, 3, 0, 1, 2 );
+}
+
+//Preset the values
+void ProgramAddressDialog::setAddress( const ProgramAddress &address )
+{
+    m_channel->setValue( address.channel );
+    m_bank->setValue( address.bank );
+    m_program->setValue( address.program );
+}
+
+//Values as set by the user
+ProgramAddress ProgramAddressDialog::address( void ) const
+{
+    ProgramAddress address;
+    address.channel = m_channel->value();
+    address.bank = m_bank->value();
+    address.program = m_program->value();
+    return address;
+}
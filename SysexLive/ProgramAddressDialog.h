@@ -0,0 +1,29 @@
+/*!
+ * \file ProgramAddressDialog.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the channel, bank and program which select a setlist entry
+ */
+
+#ifndef PROGRAMADDRESSDIALOG_H
+#define PROGRAMADDRESSDIALOG_H
+
+#include <QDialog>
+#include <QSpinBox>
+#include "ProgramMap.h"
+
+class ProgramAddressDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ProgramAddressDialog( QWidget *parent = 0 );
+    void setAddress( const ProgramAddress &address );
+    ProgramAddress address( void ) const;
+
+private:
+    QSpinBox *m_channel;
+    QSpinBox *m_bank;
+    QSpinBox *m_program;
+};
+
+#endif // PROGRAMADDRESSDIALOG_H
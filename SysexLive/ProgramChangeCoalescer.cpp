@@ -0,0 +1,57 @@
+/*!
+ * \file ProgramChangeCoalescer.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Collects bursts of program changes, only the latest one is sent
+ */
+
+#include "ProgramChangeCoalescer.h"
+
+//Constructor
+ProgramChangeCoalescer::ProgramChangeCoalescer( QObject *parent )
+    : QObject( parent )
+    , m_row( -1 )
+{
+    m_timer = new QTimer( this );
+    m_timer->setSingleShot( true );
+    m_timer->setInterval( 0 );
+    connect( m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()) );
+}
+
+//Time in ms without further program change, before the patches are sent
+void ProgramChangeCoalescer::setSettleWindow( int ms )
+{
+    m_timer->setInterval( qMax( 0, ms ) );
+}
+
+//Get settle window in ms
+int ProgramChangeCoalescer::settleWindow( void ) const
+{
+    return m_timer->interval();
+}
+
+//New program change: everything requested before is outdated
+void ProgramChangeCoalescer::request( int row )
+{
+    m_row = row;
+    emit superseded();
+
+    if( m_timer->interval() == 0 )
+    {
+        m_timer->stop();
+        onTimeout();
+    }
+    else
+    {
+        m_timer->start();
+    }
+}
+
+//Burst is over, send the latest request
+void ProgramChangeCoalescer::onTimeout( void )
+{
+    if( m_row < 0 ) return;
+    int row = m_row;
+    m_row = -1;
+    emit settled( row );
+}
@@ -0,0 +1,37 @@
+/*!
+ * \file ProgramChangeCoalescer.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Collects bursts of program changes, only the latest one is sent
+ */
+
+#ifndef PROGRAMCHANGECOALESCER_H
+#define PROGRAMCHANGECOALESCER_H
+
+#include <QObject>
+#include <QTimer>
+
+class ProgramChangeCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProgramChangeCoalescer( QObject *parent = 0 );
+    void setSettleWindow( int ms );
+    int settleWindow( void ) const;
+
+public slots:
+    void request( int row );
+
+signals:
+    void superseded( void );
+    void settled( int row );
+
+private slots:
+    void onTimeout( void );
+
+private:
+    QTimer *m_timer;
+    int m_row;
+};
+
+#endif // PROGRAMCHANGECOALESCER_H
@@ -0,0 +1,89 @@
+/*!
+ * \file ProgramChangeFastPath.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Starts sending patches directly on the MIDI thread when a program change arrives
+ */
+
+#include "ProgramChangeFastPath.h"
+
+//Constructor
+ProgramChangeFastPath::ProgramChangeFastPath( SendEngine *sendEngine )
+    : m_sendEngine( sendEngine )
+    , m_enabled( 0 )
+    , m_setlist( 0 )
+    , m_readers( 0 )
+{
+}
+
+//Destructor, the MIDI handler is removed before
+ProgramChangeFastPath::~ProgramChangeFastPath()
+{
+    m_retired.append( m_setlist.fetchAndStoreOrdered( 0 ) );
+    qDeleteAll( m_retired );
+}
+
+//Switch the fast path on or off, off: program changes go through the GUI
+void ProgramChangeFastPath::setEnabled( bool enabled )
+{
+    m_enabled.store( enabled ? 1 : 0 );
+}
+
+//Is the fast path active?
+bool ProgramChangeFastPath::isEnabled( void ) const
+{
+    return m_enabled.load() != 0;
+}
+
+//Ready to send jobs for all setlist entries, index = row, and the map to find the row. Called by the GUI after each edit.
+void ProgramChangeFastPath::setJobs( const QVector<SendJob> &jobs, const ProgramMap &programMap )
+{
+    Setlist *setlist = new Setlist;
+    setlist->jobs = jobs;
+    setlist->programMap = programMap;
+    //The MIDI thread picks up the new list with its next program change, the old one is freed later
+    const Setlist *oldSetlist = m_setlist.fetchAndStoreOrdered( setlist );
+    if( oldSetlist ) m_retired.append( oldSetlist );
+    releaseRetired();
+}
+
+//Free replaced lists, unless the MIDI thread may still be reading one of them
+void ProgramChangeFastPath::releaseRetired( void )
+{
+    //Ordered read: a reader starting after this sees the new list, a reader before is counted.
+    //If one is counted, the lists are freed with the next setJobs() instead.
+    if( m_readers.fetchAndAddOrdered( 0 ) != 0 ) return;
+    qDeleteAll( m_retired );
+    m_retired.clear();
+}
+
+//Called on the MIDI thread: send the patches of the entry without going through the GUI
+bool ProgramChangeFastPath::programChange( const QMidiEvent &event )
+{
+    if( !isEnabled() ) return false;
+
+    //No lock: announce the read, so the GUI keeps the list alive, then take the current pointer
+    m_readers.fetchAndAddOrdered( 1 );
+    const Setlist *setlist = m_setlist.loadAcquire();
+    int row = -1;
+    SendJob job;
+    if( setlist )
+    {
+        int channel = (int)event.getChannel();
+        row = setlist->programMap.lookup( channel, m_bankSelect.bank( channel ), (int)event.getValue() );
+        if( row >= 0 && row < setlist->jobs.size() ) job = setlist->jobs.at( row );
+        else row = -1;
+    }
+    m_readers.fetchAndAddOrdered( -1 );
+    if( row < 0 ) return false;
+
+    job.timestamp = event.getTimestamp();
+    m_sendEngine->submit( job );
+    return true;
+}
+
+//Called on the MIDI thread: follow bank select, even while disabled, so the bank is right when switched on
+void ProgramChangeFastPath::controlChange( const QMidiEvent &event )
+{
+    m_bankSelect.controlChange( (int)event.getChannel(), (int)event.getControl(), (int)event.getValue() );
+}
@@ -0,0 +1,50 @@
+/*!
+ * \file ProgramChangeFastPath.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Starts sending patches directly on the MIDI thread when a program change arrives
+ */
+
+#ifndef PROGRAMCHANGEFASTPATH_H
+#define PROGRAMCHANGEFASTPATH_H
+
+#include <QVector>
+#include <QList>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include "qmidiin.h"
+#include "SendEngine.h"
+#include "ProgramMap.h"
+
+class ProgramChangeFastPath : public QMidiInHandler
+{
+public:
+    explicit ProgramChangeFastPath( SendEngine *sendEngine );
+    ~ProgramChangeFastPath();
+    void setEnabled( bool enabled );
+    bool isEnabled( void ) const;
+    void setJobs( const QVector<SendJob> &jobs, const ProgramMap &programMap );
+    bool programChange( const QMidiEvent &event );
+    void controlChange( const QMidiEvent &event );
+
+private:
+    //Everything the MIDI thread needs to resolve a program change, replaced as a whole
+    struct Setlist
+    {
+        QVector<SendJob> jobs;
+        ProgramMap programMap;
+    };
+    void releaseRetired( void );
+
+    SendEngine *m_sendEngine;
+    QAtomicInt m_enabled;
+    QAtomicPointer<const Setlist> m_setlist;
+    //MIDI thread is reading a list right now, replaced lists are only freed while it is 0
+    QAtomicInt m_readers;
+    //Replaced lists waiting to be freed, only used on the GUI thread
+    QList<const Setlist*> m_retired;
+    //Only used on the MIDI thread
+    BankSelect m_bankSelect;
+};
+
+#endif // PROGRAMCHANGEFASTPATH_H
@@ -0,0 +1,96 @@
+/*!
+ * \file ProgramMap.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Maps bank select + program change to setlist entries
+ */
+
+#include "ProgramMap.h"
+#include <cstring>
+
+//Constructor
+BankSelect::BankSelect()
+{
+    reset();
+}
+
+//Track CC0/CC32, returns true if the controller was a bank select
+bool BankSelect::controlChange( int channel, int control, int value )
+{
+    if( channel < 1 || channel >= PROGRAM_MAP_CHANNELS ) return false;
+    if( control == 0 ) m_msb[channel] = value & 0x7F;
+    else if( control == 32 ) m_lsb[channel] = value & 0x7F;
+    else return false;
+    return true;
+}
+
+//Current bank of a channel, 0 if there was no bank select yet
+int BankSelect::bank( int channel ) const
+{
+    if( channel < 1 || channel >= PROGRAM_MAP_CHANNELS ) return 0;
+    return ( m_msb[channel] << 7 ) | m_lsb[channel];
+}
+
+//Back to bank 0 on all channels
+void BankSelect::reset( void )
+{
+    memset( m_msb, 0, sizeof( m_msb ) );
+    memset( m_lsb, 0, sizeof( m_lsb ) );
+}
+
+//Constructor
+ProgramMap::ProgramMap()
+{
+    build( QVector<ProgramAddress>() );
+}
+
+//Rebuild the table, index of addresses = row. If two entries have the same address, the first one wins.
+void ProgramMap::build( const QVector<ProgramAddress> &addresses )
+{
+    //Only banks which are used get a slot, so the table stays small
+    m_bankSlots.fill( -1, PROGRAM_MAP_BANKS );
+    int slots = 1;
+    for( int row = 0; row < addresses.size(); row++ )
+    {
+        int bank = addresses.at( row ).bank;
+        if( bank >= 0 && bank < PROGRAM_MAP_BANKS && m_bankSlots.at( bank ) < 0 ) m_bankSlots[bank] = slots++;
+    }
+
+    m_rows.fill( -1, slots * PROGRAM_MAP_CHANNELS * PROGRAM_MAP_PROGRAMS );
+    for( int row = 0; row < addresses.size(); row++ )
+    {
+        const ProgramAddress &address = addresses.at( row );
+        //Entries without program number keep the old behaviour: program = entry number
+        int program = address.program >= 0 ? address.program : row;
+        if( program >= PROGRAM_MAP_PROGRAMS ) continue;
+        if( address.channel < 0 || address.channel >= PROGRAM_MAP_CHANNELS ) continue;
+        int slot = ( address.bank >= 0 && address.bank < PROGRAM_MAP_BANKS ) ? m_bankSlots.at( address.bank ) : 0;
+
+        int index = ( slot * PROGRAM_MAP_CHANNELS + address.channel ) * PROGRAM_MAP_PROGRAMS + program;
+        if( m_rows.at( index ) < 0 ) m_rows[index] = row;
+    }
+}
+
+//Row for a program change, -1 if none. Exact bank and channel first, then "any".
+int ProgramMap::lookup( int channel, int bank, int program ) const
+{
+    if( program < 0 || program >= PROGRAM_MAP_PROGRAMS ) return -1;
+    if( channel < 1 || channel >= PROGRAM_MAP_CHANNELS ) channel = 0;
+
+    int slot = ( bank >= 0 && bank < PROGRAM_MAP_BANKS ) ? m_bankSlots.at( bank ) : -1;
+    int row = -1;
+    if( slot > 0 )
+    {
+        row = entry( slot, channel, program );
+        if( row < 0 ) row = entry( slot, 0, program );
+    }
+    if( row < 0 ) row = entry( 0, channel, program );
+    if( row < 0 ) row = entry( 0, 0, program );
+    return row;
+}
+
+//One cell of the table
+int ProgramMap::entry( int slot, int channel, int program ) const
+{
+    return m_rows.at( ( slot * PROGRAM_MAP_CHANNELS + channel ) * PROGRAM_MAP_PROGRAMS + program );
+}
@@ -0,0 +1,61 @@
+/*!
+ * \file ProgramMap.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Maps bank select + program change to setlist entries
+ */
+
+#ifndef PROGRAMMAP_H
+#define PROGRAMMAP_H
+
+#include <QVector>
+
+//Number of banks addressable by CC0 (MSB) and CC32 (LSB)
+#define PROGRAM_MAP_BANKS 16384
+//Channels 1..16, index 0 = any channel
+#define PROGRAM_MAP_CHANNELS 17
+#define PROGRAM_MAP_PROGRAMS 128
+
+//Address of a setlist entry
+struct ProgramAddress
+{
+    ProgramAddress() : channel( 0 ), bank( -1 ), program( -1 ) {}
+    bool isDefault( void ) const { return channel == 0 && bank < 0 && program < 0; }
+
+    int channel;    //1..16, 0 = any channel
+    int bank;       //0..16383, -1 = any bank
+    int program;    //0..127, -1 = entry number
+};
+
+//Bank select state per channel, as last set by CC0/CC32
+class BankSelect
+{
+public:
+    BankSelect();
+    bool controlChange( int channel, int control, int value );
+    int bank( int channel ) const;
+    void reset( void );
+
+private:
+    unsigned char m_msb[PROGRAM_MAP_CHANNELS];
+    unsigned char m_lsb[PROGRAM_MAP_CHANNELS];
+};
+
+//Flat lookup table (bank, channel, program) -> row, so a program change never scans the setlist
+class ProgramMap
+{
+public:
+    ProgramMap();
+    void build( const QVector<ProgramAddress> &addresses );
+    int lookup( int channel, int bank, int program ) const;
+
+private:
+    int entry( int slot, int channel, int program ) const;
+
+    //Bank -> slot in m_rows, -1 = bank not used. Slot 0 is "any bank".
+    QVector<short> m_bankSlots;
+    //[slot][channel][program] -> row, -1 = no entry
+    QVector<int> m_rows;
+};
+
+#endif // PROGRAMMAP_H
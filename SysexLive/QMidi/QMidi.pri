@@ -1,3 +1,6 @@
+#RtMidi uses std::atomic
+CONFIG += c++11
+
 macx{
     DEFINES += __MACOSX_CORE__=1
     LIBS += -framework CoreMidi
@@ -13,6 +16,11 @@ win32{
     DEFINES += __WINDOWS_MM__=1
     LIBS += -lwinmm
 }
+#Binary trace of all MIDI traffic, enable with "qmake CONFIG+=qmidi_trace"
+qmidi_trace{
+    DEFINES += QMIDI_TRACE
+}
+
 INCLUDEPATH += $$PWD
 INCLUDEPATH += $$PWD/libs/rtmidi
 
@@ -22,6 +30,10 @@ HEADERS += \
     $$PWD/qmidiin.h \
     $$PWD/qmidiout.h \
     $$PWD/qmidimessage.h \
+    $$PWD/qmidievent.h \
+    $$PWD/qmidieventqueue.h \
+    $$PWD/qmiditrace.h \
+    $$PWD/qmidiportregistry.h \
     $$PWD/qmidimapper.h \
     $$PWD/qmidipianoroll.h
 SOURCES += \
@@ -29,6 +41,10 @@ SOURCES += \
     $$PWD/qmidiin.cpp \
     $$PWD/qmidiout.cpp \
     $$PWD/qmidimessage.cpp \
+    $$PWD/qmidievent.cpp \
+    $$PWD/qmidieventqueue.cpp \
+    $$PWD/qmiditrace.cpp \
+    $$PWD/qmidiportregistry.cpp \
     $$PWD/qmidimapper.cpp \
     $$PWD/qmidipianoroll.cpp
 
@@ -55,7 +55,7 @@ MainWindow::MainWindow(QWidget *parent)
     QScrollArea *pianoRollScroll = new QScrollArea();
     QMidiPianoRoll *pianoRoll = new QMidiPianoRoll(pianoRollScroll);
     pianoRollScroll->setWidget(pianoRoll);
-    connect(_midiIn, SIGNAL(midiMessageReceived(QMidiMessage*)), pianoRoll, SLOT(onMidiReceive(QMidiMessage*)));
+    connect(_midiIn, SIGNAL(midiEventReceived(QMidiEvent)), pianoRoll, SLOT(onMidiReceive(QMidiEvent)));
     mainLayout->addWidget(pianoRollScroll);
 
 
@@ -88,7 +88,7 @@ MainWindow::MainWindow(QWidget *parent)
     mainWidget->setLayout(mainLayout);
     setCentralWidget(mainWidget);
 
-    connect(_midiIn, SIGNAL(midiMessageReceived(QMidiMessage*)), this, SLOT(onMidiMessageReceive(QMidiMessage*)));
+    connect(_midiIn, SIGNAL(midiEventReceived(QMidiEvent)), this, SLOT(onMidiEventReceive(QMidiEvent)));
 }
 
 MainWindow::~MainWindow()
@@ -96,9 +96,9 @@ MainWindow::~MainWindow()
 
 }
 
-void MainWindow::onMidiMessageReceive(QMidiMessage *message)
+void MainWindow::onMidiEventReceive(QMidiEvent event)
 {
-    _inConsole->appendPlainText("status "+QString::number(message->getStatus())+", pitch "+QString::number(message->getPitch()));
+    _inConsole->appendPlainText("status "+QString::number(event.getStatus())+", pitch "+QString::number(event.getPitch()));
 }
 
 void MainWindow::onInOpenPortButtonClicked(bool value)
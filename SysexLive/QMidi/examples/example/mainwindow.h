@@ -29,7 +29,7 @@ private:
 
 
 public slots:
-    void onMidiMessageReceive(QMidiMessage* message);
+    void onMidiEventReceive(QMidiEvent event);
 private slots:
     void onInOpenPortButtonClicked(bool value);
     void onInOpenVirtualPortButtonClicked(bool value);
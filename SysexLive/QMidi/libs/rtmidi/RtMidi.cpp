@@ -72,6 +72,7 @@ void RtMidi :: getCompiledApi( std::vector<RtMidi::Api> &apis ) throw()
 #endif
 #if defined(__LINUX_ALSA__)
   apis.push_back( LINUX_ALSA );
+  apis.push_back( LINUX_ALSA_RAW );
 #endif
 #if defined(__UNIX_JACK__)
   apis.push_back( UNIX_JACK );
@@ -101,6 +102,8 @@ void RtMidiIn :: openMidiApi( RtMidi::Api api, const std::string clientName, uns
 #if defined(__LINUX_ALSA__)
   if ( api == LINUX_ALSA )
     rtapi_ = new MidiInAlsa( clientName, queueSizeLimit );
+  if ( api == LINUX_ALSA_RAW )
+    rtapi_ = new MidiInAlsaRaw( clientName, queueSizeLimit );
 #endif
 #if defined(__WINDOWS_MM__)
   if ( api == WINDOWS_MM )
@@ -170,6 +173,8 @@ void RtMidiOut :: openMidiApi( RtMidi::Api api, const std::string clientName )
 #if defined(__LINUX_ALSA__)
   if ( api == LINUX_ALSA )
     rtapi_ = new MidiOutAlsa( clientName );
+  if ( api == LINUX_ALSA_RAW )
+    rtapi_ = new MidiOutAlsaRaw( clientName );
 #endif
 #if defined(__WINDOWS_MM__)
   if ( api == WINDOWS_MM )
@@ -275,10 +280,11 @@ void MidiApi :: error( RtMidiError::Type type, std::string errorString )
 MidiInApi :: MidiInApi( unsigned int queueSizeLimit )
   : MidiApi()
 {
-  // Allocate the MIDI queue.
-  inputData_.queue.ringSize = queueSizeLimit;
-  if ( inputData_.queue.ringSize > 0 )
+  // Allocate the MIDI queue, with the one slot which always stays free.
+  if ( queueSizeLimit > 0 ) {
+    inputData_.queue.ringSize = queueSizeLimit + 1;
     inputData_.queue.ring = new MidiMessage[ inputData_.queue.ringSize ];
+  }
 }
 
 MidiInApi :: ~MidiInApi( void )
@@ -337,18 +343,81 @@ double MidiInApi :: getMessage( std::vector<unsigned char> *message )
     return 0.0;
   }
 
-  if ( inputData_.queue.size == 0 ) return 0.0;
+  // Copy the queued message into the vector pointer argument, the
+  // caller's vector keeps its capacity for the next call.
+  MidiMessage queued;
+  queued.bytes.swap( *message );
+  bool popped = inputData_.queue.pop( queued );
+  message->swap( queued.bytes );
+  if ( !popped ) return 0.0;
+  inputData_.source = queued.source;
+  inputData_.time = queued.time;
+
+  return queued.timeStamp;
+}
+
+bool MidiInApi::MidiQueue :: push( const MidiMessage &message )
+{
+  if ( ringSize == 0 ) return false;
+  unsigned int b = back.load( std::memory_order_relaxed );
+  unsigned int next = b + 1 == ringSize ? 0 : b + 1;
+  if ( next == front.load( std::memory_order_acquire ) ) {
+    overflows.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+  }
+
+  // Copied into the preallocated slot, both sides keep their buffers
+  MidiMessage &slot = ring[b];
+  slot.bytes.assign( message.bytes.begin(), message.bytes.end() );
+  slot.timeStamp = message.timeStamp;
+  slot.source = message.source;
+  slot.time = message.time;
+  back.store( next, std::memory_order_release );
+  return true;
+}
+
+bool MidiInApi::MidiQueue :: pop( MidiMessage &message )
+{
+  unsigned int f = front.load( std::memory_order_relaxed );
+  if ( f == back.load( std::memory_order_acquire ) ) return false;
+
+  const MidiMessage &slot = ring[f];
+  message.bytes.assign( slot.bytes.begin(), slot.bytes.end() );
+  message.timeStamp = slot.timeStamp;
+  message.source = slot.source;
+  message.time = slot.time;
+  front.store( f + 1 == ringSize ? 0 : f + 1, std::memory_order_release );
+  return true;
+}
+
+void MidiInApi::MidiQueue :: reserve( size_t size )
+{
+  // Only while the input thread is stopped
+  for ( unsigned int i = 0; i < ringSize; i++ ) ring[i].bytes.reserve( size );
+}
+
+void MidiInApi :: setMessageFilter( const unsigned int *filter )
+{
+  for ( int i = 0; i < RTMIDI_FILTER_WORDS; i++ )
+    inputData_.filter[i] = filter ? filter[i] : 0xFFFFFFFF;
+}
 
-  // Copy queued message to the vector pointer argument and then "pop" it.
-  std::vector<unsigned char> *bytes = &(inputData_.queue.ring[inputData_.queue.front].bytes);
-  message->assign( bytes->begin(), bytes->end() );
-  double deltaTime = inputData_.queue.ring[inputData_.queue.front].timeStamp;
-  inputData_.queue.size--;
-  inputData_.queue.front++;
-  if ( inputData_.queue.front == inputData_.queue.ringSize )
-    inputData_.queue.front = 0;
+void MidiInApi :: setMaxSysexSize( size_t size )
+{
+  // At least room for F0 F7
+  inputData_.maxSysexSize = size < 2 ? 2 : size;
+}
 
-  return deltaTime;
+void MidiInApi :: setThreadPriority( int priority, int cpu )
+{
+  inputData_.threadPriority = priority < 0 ? 0 : priority;
+  inputData_.threadCpu = cpu;
+}
+
+void MidiInApi :: addPort( unsigned int /*portNumber*/ )
+{
+  errorString_ = "MidiInApi::addPort: listening to several ports on one connection is not supported by this API.";
+  error( RtMidiError::WARNING, errorString_ );
 }
 
 //*********************************************************************//
@@ -356,7 +425,7 @@ double MidiInApi :: getMessage( std::vector<unsigned char> *message )
 //*********************************************************************//
 
 MidiOutApi :: MidiOutApi( void )
-  : MidiApi()
+  : MidiApi(), cancelCallback_( 0 ), cancelUserData_( 0 )
 {
 }
 
@@ -364,6 +433,47 @@ MidiOutApi :: ~MidiOutApi( void )
 {
 }
 
+size_t MidiOutApi :: messageLength( const unsigned char *message, size_t size )
+{
+  if ( size == 0 ) return 0;
+  size_t length;
+  unsigned char status = message[0];
+  if ( status == 0xF0 ) {
+    // Sysex runs up to and including the end byte
+    length = 1;
+    while ( length < size && message[length - 1] != 0xF7 ) length++;
+  }
+  else if ( status >= 0xF8 || status == 0xF6 || status == 0xF7 || status < 0x80 ) length = 1;
+  else if ( status == 0xF1 || status == 0xF3 || ( status & 0xF0 ) == 0xC0 || ( status & 0xF0 ) == 0xD0 ) length = 2;
+  else length = 3;
+  return length < size ? length : size;
+}
+
+void MidiOutApi :: sendMessages( const unsigned char *messages, size_t size )
+{
+  size_t offset = 0;
+  while ( offset < size ) {
+    if ( isCancelled() ) return;
+    size_t nBytes = messageLength( messages + offset, size - offset );
+    sendMessage( messages + offset, nBytes );
+    offset += nBytes;
+  }
+}
+
+#if !defined(__LINUX_ALSA__)
+
+// No change notifications, the user polls.
+RtMidiPortWatcher :: RtMidiPortWatcher( RtMidiPortCallback /*callback*/, void * /*userData*/ )
+  : data_( 0 )
+{
+}
+
+RtMidiPortWatcher :: ~RtMidiPortWatcher( void )
+{
+}
+
+#endif
+
 // *************************************************** //
 //
 // OS/API-specific methods.
@@ -463,15 +573,8 @@ static void midiInputCallback( const MIDIPacketList *list, void *procRef, void *
           callback( message.timeStamp, &message.bytes, data->userData );
         }
         else {
-          // As long as we haven't reached our queue size limit, push the message.
-          if ( data->queue.size < data->queue.ringSize ) {
-            data->queue.ring[data->queue.back++] = message;
-            if ( data->queue.back == data->queue.ringSize )
-              data->queue.back = 0;
-            data->queue.size++;
-          }
-          else
-            std::cerr << "\nMidiInCore: message queue limit reached!!\n\n";
+          // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+          data->queue.push( message );
         }
         message.bytes.clear();
       }
@@ -527,15 +630,8 @@ static void midiInputCallback( const MIDIPacketList *list, void *procRef, void *
               callback( message.timeStamp, &message.bytes, data->userData );
             }
             else {
-              // As long as we haven't reached our queue size limit, push the message.
-              if ( data->queue.size < data->queue.ringSize ) {
-                data->queue.ring[data->queue.back++] = message;
-                if ( data->queue.back == data->queue.ringSize )
-                  data->queue.back = 0;
-                data->queue.size++;
-              }
-              else
-                std::cerr << "\nMidiInCore: message queue limit reached!!\n\n";
+              // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+              data->queue.push( message );
             }
             message.bytes.clear();
           }
@@ -989,11 +1085,11 @@ void MidiOutCore :: openVirtualPort( std::string portName )
   data->endpoint = endpoint;
 }
 
-void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutCore :: sendMessage( const unsigned char *message, size_t size )
 {
   // We use the MIDISendSysex() function to asynchronously send sysex
   // messages.  Otherwise, we use a single CoreMidi MIDIPacket.
-  unsigned int nBytes = message->size();
+  unsigned int nBytes = (unsigned int) size;
   if ( nBytes == 0 ) {
     errorString_ = "MidiOutCore::sendMessage: no data in message argument!";      
     error( RtMidiError::WARNING, errorString_ );
@@ -1004,7 +1100,7 @@ void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
   CoreMidiData *data = static_cast<CoreMidiData *> (apiData_);
   OSStatus result;
 
-  if ( message->at(0) != 0xF0 && nBytes > 3 ) {
+  if ( message[0] != 0xF0 && nBytes > 3 ) {
     errorString_ = "MidiOutCore::sendMessage: message format problem ... not sysex but > 3 bytes?";
     error( RtMidiError::WARNING, errorString_ );
     return;
@@ -1018,7 +1114,7 @@ void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
   ByteCount remainingBytes = nBytes;
   while (remainingBytes && packet) {
     ByteCount bytesForPacket = remainingBytes > 65535 ? 65535 : remainingBytes; // 65535 = maximum size of a MIDIPacket
-    const Byte* dataStartPtr = (const Byte *) &message->at( nBytes - remainingBytes );
+    const Byte* dataStartPtr = (const Byte *) &message[ nBytes - remainingBytes ];
     packet = MIDIPacketListAdd( packetList, listSize, packet, timeStamp, bytesForPacket, dataStartPtr);
     remainingBytes -= bytesForPacket; 
   }
@@ -1071,11 +1167,16 @@ void MidiOutCore :: sendMessage( std::vector<unsigned char> *message )
 // associated with the ALSA sequencer queues.
 
 #include <pthread.h>
+#include <sched.h>
 #include <sys/time.h>
+#include <time.h>
 
 // ALSA header file.
 #include <alsa/asoundlib.h>
 
+// Maximum number of input ports listened to by one MidiInAlsa
+#define RTMIDI_ALSA_MAX_SOURCES 16
+
 // A structure to hold variables related to the ALSA API
 // implementation.
 struct AlsaMidiData {
@@ -1083,6 +1184,11 @@ struct AlsaMidiData {
   unsigned int portNum;
   int vport;
   snd_seq_port_subscribe_t *subscription;
+  // Input ports subscribed to vport, index = source tag. Entry 0 uses
+  // subscription, the input thread reads the list while ports are added.
+  snd_seq_addr_t sources[RTMIDI_ALSA_MAX_SOURCES];
+  snd_seq_port_subscribe_t *sourceSubscriptions[RTMIDI_ALSA_MAX_SOURCES];
+  volatile int sourceCount;
   snd_midi_event_t *coder;
   unsigned int bufferSize;
   unsigned char *buffer;
@@ -1090,11 +1196,164 @@ struct AlsaMidiData {
   pthread_t dummy_thread_id;
   unsigned long long lastTime;
   int queue_id; // an input queue is needed to get timestamped events
+  long long queueStartTime; // CLOCK_MONOTONIC ns at queue time 0
   int trigger_fds[2];
 };
 
 #define PORT_TYPE( pinfo, bits ) ((snd_seq_port_info_get_capability(pinfo) & (bits)) == (bits))
 
+// Current CLOCK_MONOTONIC time in ns
+static long long alsaMonotonicTime( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Relate the queue time of incoming events to CLOCK_MONOTONIC, after
+// the queue was (re)started. The queue timer runs on the same clock,
+// so the offset stays valid while the queue is running.
+static void alsaSyncQueueTime( AlsaMidiData *data )
+{
+  data->queueStartTime = alsaMonotonicTime();
+#ifndef AVOID_TIMESTAMPING
+  snd_seq_queue_status_t *status;
+  snd_seq_queue_status_alloca( &status );
+  long long before = alsaMonotonicTime();
+  if ( snd_seq_get_queue_status( data->seq, data->queue_id, status ) < 0 ) return;
+  long long after = alsaMonotonicTime();
+  const snd_seq_real_time_t *queueTime = snd_seq_queue_status_get_real_time( status );
+  data->queueStartTime = before + ( after - before ) / 2
+      - ( (long long) queueTime->tv_sec * 1000000000LL + queueTime->tv_nsec );
+#endif
+}
+
+// Start an input thread with the scheduling asked for by
+// setThreadPriority().  Without permission for SCHED_FIFO the thread
+// is started with normal scheduling, a failed CPU pinning is not fatal
+// either.  Both leave a text in warning.
+static int alsaStartInputThread( pthread_t *thread, void *(*handler)( void * ), MidiInApi::RtMidiInData *data, std::string &warning )
+{
+  // Polling mode: the queue slots get room for the largest sysex now,
+  // the input thread only copies into them
+  if ( !data->usingCallback ) data->queue.reserve( data->maxSysexSize );
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  int err = EPERM;
+  data->threadRealtime = false;
+  if ( data->threadPriority > 0 ) {
+    struct sched_param param;
+    int minPriority = sched_get_priority_min( SCHED_FIFO );
+    int maxPriority = sched_get_priority_max( SCHED_FIFO );
+    param.sched_priority = data->threadPriority < minPriority ? minPriority
+        : data->threadPriority > maxPriority ? maxPriority : data->threadPriority;
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    err = pthread_create( thread, &attr, handler, data );
+    data->threadRealtime = ( err == 0 );
+    if ( err == EPERM )
+      warning = "real-time priority not permitted (rtprio limit), the input thread runs with normal priority.";
+  }
+  if ( err == EPERM ) {
+    pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    err = pthread_create( thread, &attr, handler, data );
+  }
+  pthread_attr_destroy(&attr);
+
+  if ( err == 0 && data->threadCpu >= 0 ) {
+    // CPU_SET() does no range check, a CPU beyond the set would write past it
+    cpu_set_t cpus;
+    CPU_ZERO( &cpus );
+    bool pinned = false;
+    if ( data->threadCpu < CPU_SETSIZE ) {
+      CPU_SET( data->threadCpu, &cpus );
+      pinned = ( pthread_setaffinity_np( *thread, sizeof( cpus ), &cpus ) == 0 );
+    }
+    if ( !pinned ) {
+      std::ostringstream ost;
+      ost << "the input thread can not be pinned to CPU " << data->threadCpu << ".";
+      warning += ( warning.empty() ? "" : " " ) + ost.str();
+    }
+  }
+  return err;
+}
+
+// Sequencer events which carry MIDI messages and the status byte they
+// decode to, channel messages on channel 1
+static const struct { int type; unsigned char status; bool channel; } alsaMidiEvents[] = {
+  { SND_SEQ_EVENT_NOTEOFF, 0x80, true },
+  { SND_SEQ_EVENT_NOTEON, 0x90, true },
+  { SND_SEQ_EVENT_NOTE, 0x90, true },
+  { SND_SEQ_EVENT_KEYPRESS, 0xA0, true },
+  { SND_SEQ_EVENT_CONTROLLER, 0xB0, true },
+  { SND_SEQ_EVENT_CONTROL14, 0xB0, true },
+  { SND_SEQ_EVENT_NONREGPARAM, 0xB0, true },
+  { SND_SEQ_EVENT_REGPARAM, 0xB0, true },
+  { SND_SEQ_EVENT_PGMCHANGE, 0xC0, true },
+  { SND_SEQ_EVENT_CHANPRESS, 0xD0, true },
+  { SND_SEQ_EVENT_PITCHBEND, 0xE0, true },
+  { SND_SEQ_EVENT_SYSEX, 0xF0, false },
+  { SND_SEQ_EVENT_QFRAME, 0xF1, false },
+  { SND_SEQ_EVENT_SONGPOS, 0xF2, false },
+  { SND_SEQ_EVENT_SONGSEL, 0xF3, false },
+  { SND_SEQ_EVENT_TUNE_REQUEST, 0xF6, false },
+  { SND_SEQ_EVENT_CLOCK, 0xF8, false },
+  { SND_SEQ_EVENT_TICK, 0xF9, false },
+  { SND_SEQ_EVENT_START, 0xFA, false },
+  { SND_SEQ_EVENT_CONTINUE, 0xFB, false },
+  { SND_SEQ_EVENT_STOP, 0xFC, false },
+  { SND_SEQ_EVENT_SENSING, 0xFE, false },
+  { SND_SEQ_EVENT_RESET, 0xFF, false }
+};
+
+// Status byte of an event without decoding it, -1 for events which are no MIDI messages
+static int alsaEventStatus( const snd_seq_event_t *ev )
+{
+  switch ( ev->type ) {
+  case SND_SEQ_EVENT_NOTEOFF: return 0x80 | ( ev->data.note.channel & 0x0F );
+  case SND_SEQ_EVENT_NOTEON:
+  case SND_SEQ_EVENT_NOTE: return 0x90 | ( ev->data.note.channel & 0x0F );
+  case SND_SEQ_EVENT_KEYPRESS: return 0xA0 | ( ev->data.note.channel & 0x0F );
+  case SND_SEQ_EVENT_CONTROLLER:
+  case SND_SEQ_EVENT_CONTROL14:
+  case SND_SEQ_EVENT_NONREGPARAM:
+  case SND_SEQ_EVENT_REGPARAM: return 0xB0 | ( ev->data.control.channel & 0x0F );
+  case SND_SEQ_EVENT_PGMCHANGE: return 0xC0 | ( ev->data.control.channel & 0x0F );
+  case SND_SEQ_EVENT_CHANPRESS: return 0xD0 | ( ev->data.control.channel & 0x0F );
+  case SND_SEQ_EVENT_PITCHBEND: return 0xE0 | ( ev->data.control.channel & 0x0F );
+  case SND_SEQ_EVENT_SYSEX: return 0xF0;
+  case SND_SEQ_EVENT_QFRAME: return 0xF1;
+  case SND_SEQ_EVENT_SONGPOS: return 0xF2;
+  case SND_SEQ_EVENT_SONGSEL: return 0xF3;
+  case SND_SEQ_EVENT_TUNE_REQUEST: return 0xF6;
+  case SND_SEQ_EVENT_CLOCK: return 0xF8;
+  case SND_SEQ_EVENT_TICK: return 0xF9;
+  case SND_SEQ_EVENT_START: return 0xFA;
+  case SND_SEQ_EVENT_CONTINUE: return 0xFB;
+  case SND_SEQ_EVENT_STOP: return 0xFC;
+  case SND_SEQ_EVENT_SENSING: return 0xFE;
+  case SND_SEQ_EVENT_RESET: return 0xFF;
+  default: return -1;
+  }
+}
+
+// Index of the subscribed input port an event came from, -1 if unknown
+static int alsaSourceIndex( AlsaMidiData *apiData, const snd_seq_addr_t &source )
+{
+  int count = apiData->sourceCount;
+  __sync_synchronize();
+  for ( int i = 0; i < count; i++ ) {
+    if ( apiData->sources[i].client == source.client && apiData->sources[i].port == source.port )
+      return i;
+  }
+  return -1;
+}
+
 //*********************************************************************//
 //  API: LINUX ALSA
 //  Class Definitions: MidiInAlsa
@@ -1108,28 +1367,39 @@ static void *alsaMidiHandler( void *ptr )
   long nBytes;
   unsigned long long time, lastTime;
   bool continueSysex = false;
+  bool dropSysex = false;
+  snd_seq_addr_t sysexSource = { 0, 0 };
   bool doDecode = false;
   MidiInApi::MidiMessage message;
+  // Everything but sysex is decoded here, so it can arrive in between
+  // the chunks of a sysex from another port
+  unsigned char shortMessage[16];
   int poll_fd_count;
   struct pollfd *poll_fds;
 
   snd_seq_event_t *ev;
   int result;
-  apiData->bufferSize = 32;
   result = snd_midi_event_new( 0, &apiData->coder );
   if ( result < 0 ) {
     data->doInput = false;
     std::cerr << "\nMidiInAlsa::alsaMidiHandler: error initializing MIDI event parser!\n\n";
     return 0;
   }
-  unsigned char *buffer = (unsigned char *) malloc( apiData->bufferSize );
-  if ( buffer == NULL ) {
+
+  // Sysex chunks are decoded one after another into this arena, which
+  // is allocated only here.  The message vector reserves the same size
+  // so a finished sysex is handed over without allocating either.
+  size_t arenaSize = data->maxSysexSize;
+  size_t arenaUsed = 0;
+  unsigned char *arena = (unsigned char *) malloc( arenaSize );
+  if ( arena == NULL ) {
     data->doInput = false;
     snd_midi_event_free( apiData->coder );
     apiData->coder = 0;
     std::cerr << "\nMidiInAlsa::alsaMidiHandler: error initializing buffer memory!\n\n";
     return 0;
   }
+  message.bytes.reserve( arenaSize );
   snd_midi_event_init( apiData->coder );
   snd_midi_event_no_status( apiData->coder, 1 ); // suppress running status messages
 
@@ -1165,9 +1435,18 @@ static void *alsaMidiHandler( void *ptr )
       continue;
     }
 
+    // Unwanted messages are dropped before decoding. A sysex being
+    // continued is never dropped halfway.
+    int status = alsaEventStatus( ev );
+    bool sysexChunk = continueSysex && ev->type == SND_SEQ_EVENT_SYSEX;
+    if ( status >= 0 && !sysexChunk && !data->accepts( (unsigned char) status ) ) {
+      snd_seq_free_event( ev );
+      continue;
+    }
+
     // This is a bit weird, but we now have to decode an ALSA MIDI
     // event (back) into MIDI bytes.  We'll ignore non-MIDI types.
-    if ( !continueSysex ) message.bytes.clear();
+    message.bytes.clear();
 
     doDecode = false;
     switch ( ev->type ) {
@@ -1205,18 +1484,38 @@ static void *alsaMidiHandler( void *ptr )
       if ( !( data->ignoreFlags & 0x04 ) ) doDecode = true;
       break;
 
-		case SND_SEQ_EVENT_SYSEX:
+		case SND_SEQ_EVENT_SYSEX: {
       if ( (data->ignoreFlags & 0x01) ) break;
-      if ( ev->data.ext.len > apiData->bufferSize ) {
-        apiData->bufferSize = ev->data.ext.len;
-        free( buffer );
-        buffer = (unsigned char *) malloc( apiData->bufferSize );
-        if ( buffer == NULL ) {
-          data->doInput = false;
-          std::cerr << "\nMidiInAlsa::alsaMidiHandler: error resizing buffer memory!\n\n";
-          break;
-        }
+      const unsigned char *chunk = (const unsigned char *) ev->data.ext.ptr;
+      bool lastChunk = ev->data.ext.len > 0 && chunk[ev->data.ext.len - 1] == 0xF7;
+      // There is one arena for all ports: an unfinished sysex is
+      // dropped when another port starts one.
+      if ( ( continueSysex || dropSysex ) &&
+           ( ev->source.client != sysexSource.client || ev->source.port != sysexSource.port ) ) {
+        if ( continueSysex ) data->sysexDrops.fetch_add( 1, std::memory_order_relaxed );
+        continueSysex = false;
+        dropSysex = false;
+        arenaUsed = 0;
+      }
+      sysexSource = ev->source;
+      // The rest of a dropped sysex is dropped as well, up to its
+      // last chunk, the one ending with F7.
+      if ( !continueSysex && !dropSysex && ( ev->data.ext.len == 0 || chunk[0] != 0xF0 ) ) {
+        dropSysex = !lastChunk;
+        break;
       }
+      // A sysex which does not fit into the arena is dropped up to
+      // its last chunk.
+      if ( dropSysex || arenaUsed + ev->data.ext.len > arenaSize ) {
+        if ( !dropSysex ) data->sysexDrops.fetch_add( 1, std::memory_order_relaxed );
+        dropSysex = !lastChunk;
+        continueSysex = false;
+        arenaUsed = 0;
+        break;
+      }
+      doDecode = true;
+      break;
+    }
 
     default:
       doDecode = true;
@@ -1224,20 +1523,43 @@ static void *alsaMidiHandler( void *ptr )
 
     if ( doDecode ) {
 
-      nBytes = snd_midi_event_decode( apiData->coder, buffer, apiData->bufferSize, ev );
+      // The ALSA sequencer has a maximum buffer size for MIDI sysex
+      // events of 256 bytes.  If a device sends sysex messages larger
+      // than this, they are segmented into 256 byte chunks.  So,
+      // we'll watch for this and decode the chunks one after another
+      // into the arena.
+      bool sysex = ( ev->type == SND_SEQ_EVENT_SYSEX );
+      if ( sysex )
+        nBytes = snd_midi_event_decode( apiData->coder, arena + arenaUsed, arenaSize - arenaUsed, ev );
+      else
+        nBytes = snd_midi_event_decode( apiData->coder, shortMessage, sizeof( shortMessage ), ev );
       if ( nBytes > 0 ) {
-        // The ALSA sequencer has a maximum buffer size for MIDI sysex
-        // events of 256 bytes.  If a device sends sysex messages larger
-        // than this, they are segmented into 256 byte chunks.  So,
-        // we'll watch for this and concatenate sysex chunks into a
-        // single sysex message if necessary.
-        if ( !continueSysex )
-          message.bytes.assign( buffer, &buffer[nBytes] );
-        else
-          message.bytes.insert( message.bytes.end(), buffer, &buffer[nBytes] );
-
-        continueSysex = ( ( ev->type == SND_SEQ_EVENT_SYSEX ) && ( message.bytes.back() != 0xF7 ) );
-        if ( !continueSysex ) {
+        bool complete = true;
+        if ( sysex ) {
+          arenaUsed += nBytes;
+          continueSysex = ( arena[arenaUsed - 1] != 0xF7 );
+          complete = !continueSysex;
+        }
+        if ( complete ) {
+
+          // Within the reserved capacity, no allocation. In polling mode
+          // the queue copies it into a preallocated slot.
+          if ( sysex ) {
+            message.bytes.assign( arena, arena + arenaUsed );
+            arenaUsed = 0;
+          }
+          else message.bytes.assign( shortMessage, shortMessage + nBytes );
+
+          // Tag the message with the port it came from
+          message.source = alsaSourceIndex( apiData, ev->source );
+
+          // Absolute time on CLOCK_MONOTONIC, from the queue time of the event
+#ifndef AVOID_TIMESTAMPING
+          message.time = apiData->queueStartTime
+              + (long long) ev->time.time.tv_sec * 1000000000LL + ev->time.time.tv_nsec;
+#else
+          message.time = alsaMonotonicTime();
+#endif
 
           // Calculate the time stamp:
           message.timeStamp = 0.0;
@@ -1266,26 +1588,21 @@ static void *alsaMidiHandler( void *ptr )
     }
 
     snd_seq_free_event( ev );
-    if ( message.bytes.size() == 0 || continueSysex ) continue;
+    if ( message.bytes.size() == 0 ) continue;
 
     if ( data->usingCallback ) {
       RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
+      data->source = message.source;
+      data->time = message.time;
       callback( message.timeStamp, &message.bytes, data->userData );
     }
     else {
-      // As long as we haven't reached our queue size limit, push the message.
-      if ( data->queue.size < data->queue.ringSize ) {
-        data->queue.ring[data->queue.back++] = message;
-        if ( data->queue.back == data->queue.ringSize )
-          data->queue.back = 0;
-        data->queue.size++;
-      }
-      else
-        std::cerr << "\nMidiInAlsa: message queue limit reached!!\n\n";
+      // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+      data->queue.push( message );
     }
   }
 
-  if ( buffer ) free( buffer );
+  free( arena );
   snd_midi_event_free( apiData->coder );
   apiData->coder = 0;
   apiData->thread = apiData->dummy_thread_id;
@@ -1343,6 +1660,8 @@ void MidiInAlsa :: initialize( const std::string& clientName )
   data->portNum = -1;
   data->vport = -1;
   data->subscription = 0;
+  data->sourceCount = 0;
+  data->queueStartTime = 0;
   data->dummy_thread_id = pthread_self();
   data->thread = data->dummy_thread_id;
   data->trigger_fds[0] = -1;
@@ -1514,6 +1833,9 @@ void MidiInAlsa :: openPort( unsigned int portNumber, const std::string portName
       error( RtMidiError::DRIVER_ERROR, errorString_ );
       return;
     }
+    data->sources[0] = sender;
+    data->sourceSubscriptions[0] = 0;
+    data->sourceCount = 1;
   }
 
   if ( inputData_.doInput == false ) {
@@ -1522,24 +1844,25 @@ void MidiInAlsa :: openPort( unsigned int portNumber, const std::string portName
     snd_seq_start_queue( data->seq, data->queue_id, NULL );
     snd_seq_drain_output( data->seq );
 #endif
+    alsaSyncQueueTime( data );
     // Start our MIDI input thread.
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
-
     inputData_.doInput = true;
-    int err = pthread_create(&data->thread, &attr, alsaMidiHandler, &inputData_);
-    pthread_attr_destroy(&attr);
+    std::string warning;
+    int err = alsaStartInputThread( &data->thread, alsaMidiHandler, &inputData_, warning );
     if ( err ) {
       snd_seq_unsubscribe_port( data->seq, data->subscription );
       snd_seq_port_subscribe_free( data->subscription );
       data->subscription = 0;
+      data->sourceCount = 0;
       inputData_.doInput = false;
       errorString_ = "MidiInAlsa::openPort: error starting MIDI input thread!";
       error( RtMidiError::THREAD_ERROR, errorString_ );
       return;
     }
+    if ( !warning.empty() ) {
+      errorString_ = "MidiInAlsa::openPort: " + warning;
+      error( RtMidiError::WARNING, errorString_ );
+    }
   }
 
   connected_ = true;
@@ -1584,15 +1907,11 @@ void MidiInAlsa :: openVirtualPort( std::string portName )
     snd_seq_start_queue( data->seq, data->queue_id, NULL );
     snd_seq_drain_output( data->seq );
 #endif
+    alsaSyncQueueTime( data );
     // Start our MIDI input thread.
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
-
     inputData_.doInput = true;
-    int err = pthread_create(&data->thread, &attr, alsaMidiHandler, &inputData_);
-    pthread_attr_destroy(&attr);
+    std::string warning;
+    int err = alsaStartInputThread( &data->thread, alsaMidiHandler, &inputData_, warning );
     if ( err ) {
       if ( data->subscription ) {
         snd_seq_unsubscribe_port( data->seq, data->subscription );
@@ -1604,6 +1923,101 @@ void MidiInAlsa :: openVirtualPort( std::string portName )
       error( RtMidiError::THREAD_ERROR, errorString_ );
       return;
     }
+    if ( !warning.empty() ) {
+      errorString_ = "MidiInAlsa::openVirtualPort: " + warning;
+      error( RtMidiError::WARNING, errorString_ );
+    }
+  }
+}
+
+void MidiInAlsa :: addPort( unsigned int portNumber )
+{
+  AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
+  if ( !connected_ || !data->subscription ) {
+    errorString_ = "MidiInAlsa::addPort: no connection opened by openPort() yet!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  if ( data->sourceCount >= RTMIDI_ALSA_MAX_SOURCES ) {
+    errorString_ = "MidiInAlsa::addPort: maximum number of input ports reached!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  snd_seq_port_info_t *src_pinfo;
+  snd_seq_port_info_alloca( &src_pinfo );
+  if ( portInfo( data->seq, src_pinfo, SND_SEQ_PORT_CAP_READ|SND_SEQ_PORT_CAP_SUBS_READ, (int) portNumber ) == 0 ) {
+    std::ostringstream ost;
+    ost << "MidiInAlsa::addPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtMidiError::INVALID_PARAMETER, errorString_ );
+    return;
+  }
+
+  snd_seq_addr_t sender, receiver;
+  sender.client = snd_seq_port_info_get_client( src_pinfo );
+  sender.port = snd_seq_port_info_get_port( src_pinfo );
+  receiver.client = snd_seq_client_id( data->seq );
+  receiver.port = data->vport;
+
+  // Already listening to this port
+  if ( alsaSourceIndex( data, sender ) >= 0 ) return;
+
+  // Same vport, so the running input thread gets the events without another poll loop
+  snd_seq_port_subscribe_t *subscription;
+  if ( snd_seq_port_subscribe_malloc( &subscription ) < 0 ) {
+    errorString_ = "MidiInAlsa::addPort: ALSA error allocation port subscription.";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return;
+  }
+  snd_seq_port_subscribe_set_sender( subscription, &sender );
+  snd_seq_port_subscribe_set_dest( subscription, &receiver );
+
+  // Published before subscribing, so the first event already finds its tag
+  int index = data->sourceCount;
+  data->sources[index] = sender;
+  data->sourceSubscriptions[index] = subscription;
+  __sync_synchronize();
+  data->sourceCount = index + 1;
+
+  if ( snd_seq_subscribe_port( data->seq, subscription ) ) {
+    data->sourceCount = index;
+    snd_seq_port_subscribe_free( subscription );
+    errorString_ = "MidiInAlsa::addPort: ALSA error making port connection.";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+  }
+}
+
+void MidiInAlsa :: setMessageFilter( const unsigned int *filter )
+{
+  MidiInApi::setMessageFilter( filter );
+
+  // Event types rejected on all channels are filtered by the sequencer
+  // already. The client filter lets through only the listed types.
+  AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
+  snd_seq_client_info_t *cinfo;
+  snd_seq_client_info_alloca( &cinfo );
+  if ( snd_seq_get_client_info( data->seq, cinfo ) < 0 ) return;
+
+  snd_seq_client_info_event_filter_clear( cinfo );
+  if ( filter ) {
+    // Keeps the filter list non-empty, an empty list would let everything through
+    snd_seq_client_info_event_filter_add( cinfo, SND_SEQ_EVENT_PORT_SUBSCRIBED );
+    snd_seq_client_info_event_filter_add( cinfo, SND_SEQ_EVENT_PORT_UNSUBSCRIBED );
+    for ( unsigned int i = 0; i < sizeof( alsaMidiEvents ) / sizeof( alsaMidiEvents[0] ); i++ ) {
+      int channels = alsaMidiEvents[i].channel ? 16 : 1;
+      for ( int channel = 0; channel < channels; channel++ ) {
+        if ( inputData_.accepts( alsaMidiEvents[i].status | channel ) ) {
+          snd_seq_client_info_event_filter_add( cinfo, alsaMidiEvents[i].type );
+          break;
+        }
+      }
+    }
+  }
+  if ( snd_seq_set_client_info( data->seq, cinfo ) < 0 ) {
+    errorString_ = "MidiInAlsa::setMessageFilter: error setting the sequencer event filter, messages are filtered after reception.";
+    error( RtMidiError::WARNING, errorString_ );
   }
 }
 
@@ -1617,6 +2031,11 @@ void MidiInAlsa :: closePort( void )
       snd_seq_port_subscribe_free( data->subscription );
       data->subscription = 0;
     }
+    for ( int i = 1; i < data->sourceCount; i++ ) {
+      snd_seq_unsubscribe_port( data->seq, data->sourceSubscriptions[i] );
+      snd_seq_port_subscribe_free( data->sourceSubscriptions[i] );
+    }
+    data->sourceCount = 0;
     // Stop the input queue
 #ifndef AVOID_TIMESTAMPING
     snd_seq_stop_queue( data->seq, data->queue_id, NULL );
@@ -1826,11 +2245,12 @@ void MidiOutAlsa :: openVirtualPort( std::string portName )
   }
 }
 
-void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutAlsa :: sendMessage( const unsigned char *message, size_t size )
 {
   int result;
   AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
-  unsigned int nBytes = message->size();
+  unsigned int nBytes = (unsigned int) size;
+  if ( nBytes == 0 ) return;
   if ( nBytes > data->bufferSize ) {
     data->bufferSize = nBytes;
     result = snd_midi_event_resize_buffer ( data->coder, nBytes);
@@ -1839,13 +2259,6 @@ void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
       error( RtMidiError::DRIVER_ERROR, errorString_ );
       return;
     }
-    free (data->buffer);
-    data->buffer = (unsigned char *) malloc( data->bufferSize );
-    if ( data->buffer == NULL ) {
-    errorString_ = "MidiOutAlsa::initialize: error allocating buffer memory!\n\n";
-    error( RtMidiError::MEMORY_ERROR, errorString_ );
-    return;
-    }
   }
 
   snd_seq_event_t ev;
@@ -1853,8 +2266,8 @@ void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
   snd_seq_ev_set_source(&ev, data->vport);
   snd_seq_ev_set_subs(&ev);
   snd_seq_ev_set_direct(&ev);
-  for ( unsigned int i=0; i<nBytes; ++i ) data->buffer[i] = message->at(i);
-  result = snd_midi_event_encode( data->coder, data->buffer, (long)nBytes, &ev );
+  // The encoder reads the caller's buffer directly, no copy needed.
+  result = snd_midi_event_encode( data->coder, message, (long)nBytes, &ev );
   if ( result < (int)nBytes ) {
     errorString_ = "MidiOutAlsa::sendMessage: event parsing error!";
     error( RtMidiError::WARNING, errorString_ );
@@ -1871,6 +2284,704 @@ void MidiOutAlsa :: sendMessage( std::vector<unsigned char> *message )
   snd_seq_drain_output(data->seq);
 }
 
+void MidiOutAlsa :: sendMessages( const unsigned char *messages, size_t size )
+{
+  int result;
+  AlsaMidiData *data = static_cast<AlsaMidiData *> (apiData_);
+  snd_midi_event_reset_encode( data->coder );
+
+  size_t offset = 0;
+  while ( offset < size ) {
+    if ( isCancelled() ) break;
+    unsigned int nBytes = (unsigned int) messageLength( messages + offset, size - offset );
+    if ( nBytes > data->bufferSize ) {
+      data->bufferSize = nBytes;
+      result = snd_midi_event_resize_buffer ( data->coder, nBytes);
+      if ( result != 0 ) {
+        errorString_ = "MidiOutAlsa::sendMessages: ALSA error resizing MIDI event buffer.";
+        error( RtMidiError::DRIVER_ERROR, errorString_ );
+        break;
+      }
+    }
+
+    snd_seq_event_t ev;
+    snd_seq_ev_clear(&ev);
+    snd_seq_ev_set_source(&ev, data->vport);
+    snd_seq_ev_set_subs(&ev);
+    snd_seq_ev_set_direct(&ev);
+    result = snd_midi_event_encode( data->coder, messages + offset, (long)nBytes, &ev );
+    offset += nBytes;
+    if ( result < (int)nBytes || ev.type == SND_SEQ_EVENT_NONE ) {
+      errorString_ = "MidiOutAlsa::sendMessages: event parsing error!";
+      error( RtMidiError::WARNING, errorString_ );
+      continue;
+    }
+
+    // Only queued here, the batch is drained once at the end. If the
+    // output buffer is full, it is drained early.
+    result = snd_seq_event_output(data->seq, &ev);
+    if ( result == -EAGAIN ) {
+      snd_seq_drain_output(data->seq);
+      result = snd_seq_event_output(data->seq, &ev);
+    }
+    if ( result < 0 ) {
+      errorString_ = "MidiOutAlsa::sendMessages: error sending MIDI message to port.";
+      error( RtMidiError::WARNING, errorString_ );
+      break;
+    }
+  }
+  snd_seq_drain_output(data->seq);
+}
+
+//*********************************************************************//
+//  API: LINUX ALSA port watcher
+//*********************************************************************//
+
+// The watcher has its own sequencer client, with a hidden port
+// connected to the announce port of the system client.
+
+struct AlsaPortWatcherData {
+  snd_seq_t *seq;
+  pthread_t thread;
+  int trigger_fds[2];
+  volatile bool watching;
+  RtMidiPortWatcher::RtMidiPortCallback callback;
+  void *userData;
+};
+
+static void *alsaPortWatcherHandler( void *ptr )
+{
+  AlsaPortWatcherData *data = static_cast<AlsaPortWatcherData *> (ptr);
+
+  int poll_fd_count = snd_seq_poll_descriptors_count( data->seq, POLLIN ) + 1;
+  struct pollfd *poll_fds = (struct pollfd*)alloca( poll_fd_count * sizeof( struct pollfd ));
+  snd_seq_poll_descriptors( data->seq, poll_fds + 1, poll_fd_count - 1, POLLIN );
+  poll_fds[0].fd = data->trigger_fds[0];
+  poll_fds[0].events = POLLIN;
+
+  bool changed = false;
+  while ( data->watching ) {
+
+    if ( snd_seq_event_input_pending( data->seq, 1 ) == 0 ) {
+      // All announcements of a burst are read, tell the user once
+      if ( changed ) {
+        changed = false;
+        data->callback( data->userData );
+      }
+      if ( poll( poll_fds, poll_fd_count, -1) >= 0 ) {
+        if ( poll_fds[0].revents & POLLIN ) {
+          bool dummy;
+          int res = read( poll_fds[0].fd, &dummy, sizeof(dummy) );
+          (void) res;
+        }
+      }
+      continue;
+    }
+
+    snd_seq_event_t *ev;
+    if ( snd_seq_event_input( data->seq, &ev ) < 0 ) continue;
+    switch ( ev->type ) {
+    case SND_SEQ_EVENT_CLIENT_START:
+    case SND_SEQ_EVENT_CLIENT_EXIT:
+    case SND_SEQ_EVENT_CLIENT_CHANGE:
+    case SND_SEQ_EVENT_PORT_START:
+    case SND_SEQ_EVENT_PORT_EXIT:
+    case SND_SEQ_EVENT_PORT_CHANGE:
+      changed = true;
+      break;
+    default:
+      break;
+    }
+    snd_seq_free_event( ev );
+  }
+
+  return 0;
+}
+
+RtMidiPortWatcher :: RtMidiPortWatcher( RtMidiPortCallback callback, void *userData )
+  : data_( 0 )
+{
+  if ( !callback ) return;
+
+  snd_seq_t *seq;
+  if ( snd_seq_open( &seq, "default", SND_SEQ_OPEN_INPUT, SND_SEQ_NONBLOCK ) < 0 ) return;
+  snd_seq_set_client_name( seq, "RtMidi Port Watcher" );
+
+  // Hidden from other applications, nobody else may connect to it
+  int port = snd_seq_create_simple_port( seq, "announce",
+                                         SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+                                         SND_SEQ_PORT_TYPE_APPLICATION );
+  if ( port < 0 ||
+       snd_seq_connect_from( seq, port, SND_SEQ_CLIENT_SYSTEM, SND_SEQ_PORT_SYSTEM_ANNOUNCE ) < 0 ) {
+    snd_seq_close( seq );
+    return;
+  }
+
+  AlsaPortWatcherData *data = new AlsaPortWatcherData;
+  data->seq = seq;
+  data->watching = true;
+  data->callback = callback;
+  data->userData = userData;
+  if ( pipe( data->trigger_fds ) == -1 ) {
+    snd_seq_close( seq );
+    delete data;
+    return;
+  }
+
+  if ( pthread_create( &data->thread, NULL, alsaPortWatcherHandler, data ) != 0 ) {
+    close( data->trigger_fds[0] );
+    close( data->trigger_fds[1] );
+    snd_seq_close( seq );
+    delete data;
+    return;
+  }
+
+  data_ = (void *) data;
+}
+
+RtMidiPortWatcher :: ~RtMidiPortWatcher( void )
+{
+  AlsaPortWatcherData *data = static_cast<AlsaPortWatcherData *> (data_);
+  if ( !data ) return;
+
+  // Wake up the thread and wait until it is gone
+  data->watching = false;
+  bool dummy = false;
+  int res = write( data->trigger_fds[1], &dummy, sizeof(dummy) );
+  (void) res;
+  pthread_join( data->thread, NULL );
+
+  close( data->trigger_fds[0] );
+  close( data->trigger_fds[1] );
+  snd_seq_close( data->seq );
+  delete data;
+}
+
+//*********************************************************************//
+//  API: LINUX ALSA RAWMIDI
+//*********************************************************************//
+
+// The rawmidi API talks to the MIDI devices of the sound cards
+// directly.  There is no sequencer in between, so sysex is read and
+// written in full buffers instead of 256 byte events, and no event
+// encoding or decoding is needed.  Software ports and virtual ports
+// are not available.
+
+// Bytes read from the device at once.
+#define RTMIDI_RAWMIDI_READ_SIZE 4096
+// Kernel buffer for outgoing data, big enough for most bulk dumps.
+#define RTMIDI_RAWMIDI_OUTPUT_BUFFER 65536
+// Bytes written at once.  In append mode a write is all or nothing, so
+// this has to fit into the smallest (default) kernel buffer.
+#define RTMIDI_RAWMIDI_WRITE_SIZE 4096
+// A full output buffer is waited for in steps of this many ms, a
+// cancelled send stops after at most one step.
+#define RTMIDI_RAWMIDI_POLL_MS 10
+
+// A structure to hold variables related to the ALSA rawmidi API
+// implementation.
+struct AlsaRawMidiData {
+  snd_rawmidi_t *handle;
+  pthread_t thread;
+  pthread_t dummy_thread_id;
+  long long lastTime;
+  int trigger_fds[2];
+  size_t bufferSize;
+};
+
+// Count the rawmidi subdevices of one direction or get the device and
+// display name of one of them, like portInfo() for the sequencer.
+static unsigned int rawMidiPortInfo( snd_rawmidi_stream_t stream, int portNumber, std::string *device, std::string *name )
+{
+  snd_rawmidi_info_t *info;
+  snd_rawmidi_info_alloca( &info );
+  int count = 0;
+  int card = -1;
+  while ( snd_card_next( &card ) >= 0 && card >= 0 ) {
+    std::ostringstream cardName;
+    cardName << "hw:" << card;
+    snd_ctl_t *ctl;
+    if ( snd_ctl_open( &ctl, cardName.str().c_str(), 0 ) < 0 ) continue;
+
+    int dev = -1;
+    while ( snd_ctl_rawmidi_next_device( ctl, &dev ) >= 0 && dev >= 0 ) {
+      snd_rawmidi_info_set_device( info, dev );
+      snd_rawmidi_info_set_subdevice( info, 0 );
+      snd_rawmidi_info_set_stream( info, stream );
+      if ( snd_ctl_rawmidi_info( ctl, info ) < 0 ) continue;
+
+      int subs = snd_rawmidi_info_get_subdevices_count( info );
+      if ( portNumber < count || portNumber >= count + subs ) {
+        count += subs;
+        continue;
+      }
+
+      int sub = portNumber - count;
+      snd_rawmidi_info_set_subdevice( info, sub );
+      snd_ctl_rawmidi_info( ctl, info );
+      std::ostringstream os;
+      os << "hw:" << card << "," << dev << "," << sub;
+      if ( device ) *device = os.str();
+      if ( name ) {
+        const char *subName = snd_rawmidi_info_get_subdevice_name( info );
+        *name = std::string( subName && *subName ? subName : snd_rawmidi_info_get_name( info ) ) + " " + os.str();
+      }
+      snd_ctl_close( ctl );
+      return 1;
+    }
+    snd_ctl_close( ctl );
+  }
+
+  // If a negative portNumber was used, return the port count.
+  if ( portNumber < 0 ) return count;
+  return 0;
+}
+
+// Hand a complete message to the user, with the same filtering as the sequencer input
+static void rawMidiDeliver( MidiInApi::RtMidiInData *data, AlsaRawMidiData *apiData, MidiInApi::MidiMessage &message, long long time )
+{
+  unsigned char status = message.bytes[0];
+  if ( status == 0xF0 && ( data->ignoreFlags & 0x01 ) ) return;
+  if ( ( status == 0xF1 || status == 0xF8 || status == 0xF9 ) && ( data->ignoreFlags & 0x02 ) ) return;
+  if ( status == 0xFE && ( data->ignoreFlags & 0x04 ) ) return;
+  if ( !data->accepts( status ) ) return;
+
+  message.source = 0;
+  message.time = time;
+  message.timeStamp = 0.0;
+  if ( data->firstMessage == true )
+    data->firstMessage = false;
+  else
+    message.timeStamp = ( time - apiData->lastTime ) * 0.000000001;
+  apiData->lastTime = time;
+
+  if ( data->usingCallback ) {
+    RtMidiIn::RtMidiCallback callback = (RtMidiIn::RtMidiCallback) data->userCallback;
+    data->source = message.source;
+    data->time = message.time;
+    callback( message.timeStamp, &message.bytes, data->userData );
+  }
+  else {
+    // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+    data->queue.push( message );
+  }
+}
+
+static void *alsaRawMidiHandler( void *ptr )
+{
+  MidiInApi::RtMidiInData *data = static_cast<MidiInApi::RtMidiInData *> (ptr);
+  AlsaRawMidiData *apiData = static_cast<AlsaRawMidiData *> (data->apiData);
+
+  unsigned char buffer[RTMIDI_RAWMIDI_READ_SIZE];
+  MidiInApi::MidiMessage message;
+  MidiInApi::MidiMessage realtime;
+  unsigned char runningStatus = 0;
+  size_t expected = 0;
+  bool inSysex = false;
+  bool dropSysex = false;
+
+  // Sysex is collected in place, allocated once here
+  size_t maxSysexSize = data->maxSysexSize;
+  message.bytes.reserve( maxSysexSize );
+
+  int poll_fd_count = snd_rawmidi_poll_descriptors_count( apiData->handle ) + 1;
+  struct pollfd *poll_fds = (struct pollfd*)alloca( poll_fd_count * sizeof( struct pollfd ));
+  snd_rawmidi_poll_descriptors( apiData->handle, poll_fds + 1, poll_fd_count - 1 );
+  poll_fds[0].fd = apiData->trigger_fds[0];
+  poll_fds[0].events = POLLIN;
+
+  while ( data->doInput ) {
+
+    ssize_t nBytes = snd_rawmidi_read( apiData->handle, buffer, sizeof( buffer ) );
+    if ( nBytes == -EAGAIN || nBytes == 0 ) {
+      // No data pending
+      if ( poll( poll_fds, poll_fd_count, -1) >= 0 ) {
+        if ( poll_fds[0].revents & POLLIN ) {
+          bool dummy;
+          int res = read( poll_fds[0].fd, &dummy, sizeof(dummy) );
+          (void) res;
+        }
+      }
+      continue;
+    }
+    if ( nBytes < 0 ) {
+      // Device is gone, closePort() ends the thread
+      data->inputErrors.fetch_add( 1, std::memory_order_relaxed );
+      poll( poll_fds, 1, -1 );
+      continue;
+    }
+
+    // All bytes of one read arrived at the same time
+    long long time = alsaMonotonicTime();
+    for ( ssize_t i = 0; i < nBytes; i++ ) {
+      unsigned char byte = buffer[i];
+
+      // Real-time messages may show up anywhere, even inside sysex
+      if ( byte >= 0xF8 ) {
+        realtime.bytes.assign( 1, byte );
+        rawMidiDeliver( data, apiData, realtime, time );
+        continue;
+      }
+
+      if ( byte & 0x80 ) {
+        if ( inSysex ) {
+          inSysex = false;
+          if ( byte == 0xF7 && !dropSysex ) {
+            message.bytes.push_back( byte );
+            rawMidiDeliver( data, apiData, message, time );
+            message.bytes.clear();
+            continue;
+          }
+          // Any other status aborts the sysex, it is dropped
+          message.bytes.clear();
+        }
+        if ( byte == 0xF7 ) continue;
+
+        message.bytes.assign( 1, byte );
+        if ( byte == 0xF0 ) {
+          inSysex = true;
+          dropSysex = false;
+          runningStatus = 0;
+          continue;
+        }
+
+        // System common messages cancel running status
+        runningStatus = byte < 0xF0 ? byte : 0;
+        expected = MidiOutApi::messageLength( &byte, 3 );
+        if ( expected == 1 ) {
+          rawMidiDeliver( data, apiData, message, time );
+          message.bytes.clear();
+        }
+        continue;
+      }
+
+      // Data byte
+      if ( inSysex ) {
+        // Leave room for F7, a longer sysex is dropped as a whole
+        if ( message.bytes.size() + 1 < maxSysexSize )
+          message.bytes.push_back( byte );
+        else if ( !dropSysex ) {
+          dropSysex = true;
+          data->sysexDrops.fetch_add( 1, std::memory_order_relaxed );
+        }
+        continue;
+      }
+      if ( message.bytes.empty() ) {
+        if ( !runningStatus ) continue;
+        message.bytes.assign( 1, runningStatus );
+        expected = MidiOutApi::messageLength( &runningStatus, 3 );
+      }
+      message.bytes.push_back( byte );
+      if ( message.bytes.size() == expected ) {
+        rawMidiDeliver( data, apiData, message, time );
+        message.bytes.clear();
+      }
+    }
+  }
+
+  apiData->thread = apiData->dummy_thread_id;
+  return 0;
+}
+
+MidiInAlsaRaw :: MidiInAlsaRaw( const std::string clientName, unsigned int queueSizeLimit ) : MidiInApi( queueSizeLimit )
+{
+  initialize( clientName );
+}
+
+MidiInAlsaRaw :: ~MidiInAlsaRaw()
+{
+  // Close a connection if it exists, this also stops the input thread.
+  closePort();
+
+  // Cleanup.
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  close ( data->trigger_fds[0] );
+  close ( data->trigger_fds[1] );
+  delete data;
+}
+
+void MidiInAlsaRaw :: initialize( const std::string& /*clientName*/ )
+{
+  // Save our api-specific connection information.
+  AlsaRawMidiData *data = (AlsaRawMidiData *) new AlsaRawMidiData;
+  data->handle = 0;
+  data->dummy_thread_id = pthread_self();
+  data->thread = data->dummy_thread_id;
+  data->lastTime = 0;
+  data->trigger_fds[0] = -1;
+  data->trigger_fds[1] = -1;
+  data->bufferSize = 0;
+  apiData_ = (void *) data;
+  inputData_.apiData = (void *) data;
+
+  if ( pipe(data->trigger_fds) == -1 ) {
+    errorString_ = "MidiInAlsaRaw::initialize: error creating pipe objects.";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return;
+  }
+}
+
+unsigned int MidiInAlsaRaw :: getPortCount()
+{
+  return rawMidiPortInfo( SND_RAWMIDI_STREAM_INPUT, -1, 0, 0 );
+}
+
+std::string MidiInAlsaRaw :: getPortName( unsigned int portNumber )
+{
+  std::string stringName;
+  if ( rawMidiPortInfo( SND_RAWMIDI_STREAM_INPUT, (int) portNumber, 0, &stringName ) ) return stringName;
+
+  // If we get here, we didn't find a match.
+  errorString_ = "MidiInAlsaRaw::getPortName: error looking for port name!";
+  error( RtMidiError::WARNING, errorString_ );
+  return stringName;
+}
+
+void MidiInAlsaRaw :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "MidiInAlsaRaw::openPort: a valid connection already exists!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  std::string device;
+  if ( rawMidiPortInfo( SND_RAWMIDI_STREAM_INPUT, (int) portNumber, &device, 0 ) == 0 ) {
+    std::ostringstream ost;
+    ost << "MidiInAlsaRaw::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtMidiError::INVALID_PARAMETER, errorString_ );
+    return;
+  }
+
+  // Non-blocking, the input thread waits in poll() together with the stop trigger
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( snd_rawmidi_open( &data->handle, NULL, device.c_str(), SND_RAWMIDI_NONBLOCK ) < 0 ) {
+    data->handle = 0;
+    errorString_ = "MidiInAlsaRaw::openPort: error opening rawmidi device " + device + ".";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return;
+  }
+
+  // Start our MIDI input thread.
+  inputData_.doInput = true;
+  inputData_.firstMessage = true;
+  std::string warning;
+  int err = alsaStartInputThread( &data->thread, alsaRawMidiHandler, &inputData_, warning );
+  if ( err ) {
+    snd_rawmidi_close( data->handle );
+    data->handle = 0;
+    inputData_.doInput = false;
+    errorString_ = "MidiInAlsaRaw::openPort: error starting MIDI input thread!";
+    error( RtMidiError::THREAD_ERROR, errorString_ );
+    return;
+  }
+  if ( !warning.empty() ) {
+    errorString_ = "MidiInAlsaRaw::openPort: " + warning;
+    error( RtMidiError::WARNING, errorString_ );
+  }
+
+  connected_ = true;
+}
+
+void MidiInAlsaRaw :: openVirtualPort( const std::string /*portName*/ )
+{
+  errorString_ = "MidiInAlsaRaw::openVirtualPort: virtual ports need the ALSA sequencer (LINUX_ALSA).";
+  error( RtMidiError::WARNING, errorString_ );
+}
+
+void MidiInAlsaRaw :: closePort( void )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+
+  // Stop thread before the device goes away
+  if ( inputData_.doInput ) {
+    inputData_.doInput = false;
+    int res = write( data->trigger_fds[1], &inputData_.doInput, sizeof(inputData_.doInput) );
+    (void) res;
+    if ( !pthread_equal(data->thread, data->dummy_thread_id) )
+      pthread_join( data->thread, NULL );
+  }
+
+  if ( data->handle ) {
+    snd_rawmidi_close( data->handle );
+    data->handle = 0;
+  }
+  connected_ = false;
+}
+
+MidiOutAlsaRaw :: MidiOutAlsaRaw( const std::string clientName ) : MidiOutApi()
+{
+  initialize( clientName );
+}
+
+MidiOutAlsaRaw :: ~MidiOutAlsaRaw()
+{
+  // Close a connection if it exists.
+  closePort();
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  delete data;
+}
+
+void MidiOutAlsaRaw :: initialize( const std::string& /*clientName*/ )
+{
+  AlsaRawMidiData *data = (AlsaRawMidiData *) new AlsaRawMidiData;
+  data->handle = 0;
+  data->dummy_thread_id = pthread_self();
+  data->thread = data->dummy_thread_id;
+  data->lastTime = 0;
+  data->trigger_fds[0] = -1;
+  data->trigger_fds[1] = -1;
+  data->bufferSize = 0;
+  apiData_ = (void *) data;
+}
+
+unsigned int MidiOutAlsaRaw :: getPortCount()
+{
+  return rawMidiPortInfo( SND_RAWMIDI_STREAM_OUTPUT, -1, 0, 0 );
+}
+
+std::string MidiOutAlsaRaw :: getPortName( unsigned int portNumber )
+{
+  std::string stringName;
+  if ( rawMidiPortInfo( SND_RAWMIDI_STREAM_OUTPUT, (int) portNumber, 0, &stringName ) ) return stringName;
+
+  // If we get here, we didn't find a match.
+  errorString_ = "MidiOutAlsaRaw::getPortName: error looking for port name!";
+  error( RtMidiError::WARNING, errorString_ );
+  return stringName;
+}
+
+void MidiOutAlsaRaw :: openPort( unsigned int portNumber, const std::string /*portName*/ )
+{
+  if ( connected_ ) {
+    errorString_ = "MidiOutAlsaRaw::openPort: a valid connection already exists!";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  std::string device;
+  if ( rawMidiPortInfo( SND_RAWMIDI_STREAM_OUTPUT, (int) portNumber, &device, 0 ) == 0 ) {
+    std::ostringstream ost;
+    ost << "MidiOutAlsaRaw::openPort: the 'portNumber' argument (" << portNumber << ") is invalid.";
+    errorString_ = ost.str();
+    error( RtMidiError::INVALID_PARAMETER, errorString_ );
+    return;
+  }
+
+  // Append mode shares the device with other programs without splitting
+  // their writes, non-blocking so sendMessages() can wait in poll()
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  int result = snd_rawmidi_open( NULL, &data->handle, device.c_str(), SND_RAWMIDI_APPEND | SND_RAWMIDI_NONBLOCK );
+  if ( result < 0 ) {
+    data->handle = 0;
+    errorString_ = "MidiOutAlsaRaw::openPort: error opening rawmidi device " + device + ": " + snd_strerror( result ) + ".";
+    error( RtMidiError::DRIVER_ERROR, errorString_ );
+    return;
+  }
+
+  // The device is writable (POLLOUT) only once the whole buffer is
+  // free again, so drain() and a full buffer both wait in poll()
+  data->bufferSize = 0;
+  snd_rawmidi_params_t *params;
+  snd_rawmidi_params_alloca( &params );
+  if ( snd_rawmidi_params_current( data->handle, params ) >= 0 ) {
+    if ( snd_rawmidi_params_set_buffer_size( data->handle, params, RTMIDI_RAWMIDI_OUTPUT_BUFFER ) < 0 ||
+         snd_rawmidi_params( data->handle, params ) < 0 )
+      snd_rawmidi_params_current( data->handle, params );
+    if ( snd_rawmidi_params_set_avail_min( data->handle, params, snd_rawmidi_params_get_buffer_size( params ) ) >= 0 &&
+         snd_rawmidi_params( data->handle, params ) >= 0 )
+      data->bufferSize = snd_rawmidi_params_get_buffer_size( params );
+  }
+
+  connected_ = true;
+}
+
+void MidiOutAlsaRaw :: openVirtualPort( const std::string /*portName*/ )
+{
+  errorString_ = "MidiOutAlsaRaw::openVirtualPort: virtual ports need the ALSA sequencer (LINUX_ALSA).";
+  error( RtMidiError::WARNING, errorString_ );
+}
+
+void MidiOutAlsaRaw :: closePort( void )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( data->handle ) {
+    snd_rawmidi_close( data->handle );
+    data->handle = 0;
+  }
+  connected_ = false;
+}
+
+void MidiOutAlsaRaw :: sendMessage( const unsigned char *message, size_t size )
+{
+  // The device takes a plain byte stream, so one message or many are the same
+  sendMessages( message, size );
+}
+
+void MidiOutAlsaRaw :: sendMessages( const unsigned char *messages, size_t size )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( !data->handle ) {
+    errorString_ = "MidiOutAlsaRaw::sendMessages: no open port.";
+    error( RtMidiError::WARNING, errorString_ );
+    return;
+  }
+
+  int poll_fd_count = snd_rawmidi_poll_descriptors_count( data->handle );
+  struct pollfd *poll_fds = (struct pollfd*)alloca( poll_fd_count * sizeof( struct pollfd ));
+  snd_rawmidi_poll_descriptors( data->handle, poll_fds, poll_fd_count );
+
+  // Write as much as fits, wait in poll() while the kernel buffer is full
+  size_t offset = 0;
+  while ( offset < size ) {
+    size_t nBytes = size - offset < RTMIDI_RAWMIDI_WRITE_SIZE ? size - offset : RTMIDI_RAWMIDI_WRITE_SIZE;
+    ssize_t result = snd_rawmidi_write( data->handle, messages + offset, nBytes );
+    if ( result == -EINTR ) continue;
+    if ( result == -EAGAIN ) {
+      if ( isCancelled() ) break;
+      poll( poll_fds, poll_fd_count, RTMIDI_RAWMIDI_POLL_MS );
+      continue;
+    }
+    if ( result < 0 ) {
+      errorString_ = "MidiOutAlsaRaw::sendMessages: error writing to rawmidi device.";
+      error( RtMidiError::WARNING, errorString_ );
+      return;
+    }
+    offset += result;
+  }
+  if ( offset == size ) return;
+
+  // Cancelled: a sysex cut in the middle is ended, so the synth drops it
+  size_t i = offset;
+  while ( i > 0 && ( messages[i - 1] < 0x80 || messages[i - 1] >= 0xF8 ) ) i--;
+  if ( i > 0 && messages[i - 1] == 0xF0 ) {
+    const unsigned char eox = 0xF7;
+    while ( snd_rawmidi_write( data->handle, &eox, 1 ) == -EAGAIN )
+      poll( poll_fds, poll_fd_count, RTMIDI_RAWMIDI_POLL_MS );
+  }
+}
+
+void MidiOutAlsaRaw :: drain( void )
+{
+  AlsaRawMidiData *data = static_cast<AlsaRawMidiData *> (apiData_);
+  if ( !data->handle || data->bufferSize == 0 ) return;
+
+  int poll_fd_count = snd_rawmidi_poll_descriptors_count( data->handle );
+  struct pollfd *poll_fds = (struct pollfd*)alloca( poll_fd_count * sizeof( struct pollfd ));
+  snd_rawmidi_poll_descriptors( data->handle, poll_fds, poll_fd_count );
+
+  // Not snd_rawmidi_drain(), it can not be cancelled. Messages are
+  // never cut here, a cancelled wait leaves the rest in the buffer.
+  snd_rawmidi_status_t *status;
+  snd_rawmidi_status_alloca( &status );
+  while ( snd_rawmidi_status( data->handle, status ) >= 0 &&
+          snd_rawmidi_status_get_avail( status ) < data->bufferSize ) {
+    if ( isCancelled() ) return;
+    poll( poll_fds, poll_fd_count, RTMIDI_RAWMIDI_POLL_MS );
+  }
+}
+
 #endif // __LINUX_ALSA__
 
 
@@ -1996,15 +3107,8 @@ static void CALLBACK midiInputCallback( HMIDIIN /*hmin*/,
     callback( apiData->message.timeStamp, &apiData->message.bytes, data->userData );
   }
   else {
-    // As long as we haven't reached our queue size limit, push the message.
-    if ( data->queue.size < data->queue.ringSize ) {
-      data->queue.ring[data->queue.back++] = apiData->message;
-      if ( data->queue.back == data->queue.ringSize )
-        data->queue.back = 0;
-      data->queue.size++;
-    }
-    else
-      std::cerr << "\nRtMidiIn: message queue limit reached!!\n\n";
+    // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+    data->queue.push( apiData->message );
   }
 
   // Clear the vector for the next input message.
@@ -2323,11 +3427,11 @@ void MidiOutWinMM :: openVirtualPort( std::string /*portName*/ )
   error( RtMidiError::WARNING, errorString_ );
 }
 
-void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutWinMM :: sendMessage( const unsigned char *message, size_t size )
 {
   if ( !connected_ ) return;
 
-  unsigned int nBytes = static_cast<unsigned int>(message->size());
+  unsigned int nBytes = static_cast<unsigned int>(size);
   if ( nBytes == 0 ) {
     errorString_ = "MidiOutWinMM::sendMessage: message argument is empty!";
     error( RtMidiError::WARNING, errorString_ );
@@ -2336,27 +3440,16 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
 
   MMRESULT result;
   WinMidiData *data = static_cast<WinMidiData *> (apiData_);
-  if ( message->at(0) == 0xF0 ) { // Sysex message
+  if ( message[0] == 0xF0 ) { // Sysex message
 
-    // Allocate buffer for sysex data.
-    char *buffer = (char *) malloc( nBytes );
-    if ( buffer == NULL ) {
-      errorString_ = "MidiOutWinMM::sendMessage: error allocating sysex message memory!";
-      error( RtMidiError::MEMORY_ERROR, errorString_ );
-      return;
-    }
-
-    // Copy data to buffer.
-    for ( unsigned int i=0; i<nBytes; ++i ) buffer[i] = message->at(i);
-
-    // Create and prepare MIDIHDR structure.
+    // Create and prepare MIDIHDR structure.  The driver only reads the
+    // buffer and we wait for it below, so the caller's data is used as is.
     MIDIHDR sysex;
-    sysex.lpData = (LPSTR) buffer;
+    sysex.lpData = (LPSTR) message;
     sysex.dwBufferLength = nBytes;
     sysex.dwFlags = 0;
     result = midiOutPrepareHeader( data->outHandle,  &sysex, sizeof(MIDIHDR) ); 
     if ( result != MMSYSERR_NOERROR ) {
-      free( buffer );
       errorString_ = "MidiOutWinMM::sendMessage: error preparing sysex header.";
       error( RtMidiError::DRIVER_ERROR, errorString_ );
       return;
@@ -2365,7 +3458,6 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
     // Send the message.
     result = midiOutLongMsg( data->outHandle, &sysex, sizeof(MIDIHDR) );
     if ( result != MMSYSERR_NOERROR ) {
-      free( buffer );
       errorString_ = "MidiOutWinMM::sendMessage: error sending sysex message.";
       error( RtMidiError::DRIVER_ERROR, errorString_ );
       return;
@@ -2373,7 +3465,6 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
 
     // Unprepare the buffer and MIDIHDR.
     while ( MIDIERR_STILLPLAYING == midiOutUnprepareHeader( data->outHandle, &sysex, sizeof (MIDIHDR) ) ) Sleep( 1 );
-    free( buffer );
   }
   else { // Channel or system message.
 
@@ -2385,10 +3476,10 @@ void MidiOutWinMM :: sendMessage( std::vector<unsigned char> *message )
     }
 
     // Pack MIDI bytes into double word.
-    DWORD packet;
+    DWORD packet = 0;
     unsigned char *ptr = (unsigned char *) &packet;
     for ( unsigned int i=0; i<nBytes; ++i ) {
-      *ptr = message->at(i);
+      *ptr = message[i];
       ++ptr;
     }
 
@@ -2472,15 +3563,8 @@ static int jackProcessIn( jack_nframes_t nframes, void *arg )
         callback( message.timeStamp, &message.bytes, rtData->userData );
       }
       else {
-        // As long as we haven't reached our queue size limit, push the message.
-        if ( rtData->queue.size < rtData->queue.ringSize ) {
-          rtData->queue.ring[rtData->queue.back++] = message;
-          if ( rtData->queue.back == rtData->queue.ringSize )
-            rtData->queue.back = 0;
-          rtData->queue.size++;
-        }
-        else
-          std::cerr << "\nMidiInJack: message queue limit reached!!\n\n";
+        // Lock-free hand-off, a full queue counts in getQueueOverflowCount().
+        rtData->queue.push( message );
       }
     }
   }
@@ -2805,14 +3889,13 @@ void MidiOutJack :: closePort()
   data->port = NULL;
 }
 
-void MidiOutJack :: sendMessage( std::vector<unsigned char> *message )
+void MidiOutJack :: sendMessage( const unsigned char *message, size_t size )
 {
-  int nBytes = message->size();
+  int nBytes = (int) size;
   JackMidiData *data = static_cast<JackMidiData *> (apiData_);
 
   // Write full message to buffer
-  jack_ringbuffer_write( data->buffMessage, ( const char * ) &( *message )[0],
-                         message->size() );
+  jack_ringbuffer_write( data->buffMessage, ( const char * ) message, size );
   jack_ringbuffer_write( data->buffSize, ( char * ) &nBytes, sizeof( nBytes ) );
 }
 
@@ -45,6 +45,16 @@
 
 #define RTMIDI_VERSION "2.1.0"
 
+// Words of the message filter bitmap, one bit per status byte
+#define RTMIDI_FILTER_WORDS 8
+
+// Default for the largest incoming sysex, see RtMidiIn::setMaxSysexSize()
+#define RTMIDI_DEFAULT_MAX_SYSEX 65536
+
+// Assumed cache line size, keeps the input queue indices apart
+#define RTMIDI_CACHE_LINE 64
+
+#include <atomic>
 #include <exception>
 #include <iostream>
 #include <string>
@@ -111,6 +121,16 @@ class RtMidiError : public std::exception
  */
 typedef void (*RtMidiErrorCallback)( RtMidiError::Type type, const std::string &errorText, void *userData );
 
+//! RtMidi cancel callback function prototype.
+/*!
+    \param userData As passed to RtMidiOut::setCancelCallback().
+    \return true to abort the running sendMessages() call.
+
+    Called from the sending thread while sendMessages() waits for the
+    device, so it has to be cheap and thread safe.
+ */
+typedef bool (*RtMidiCancelCallback)( void *userData );
+
 class MidiApi;
 
 class RtMidi
@@ -124,7 +144,8 @@ class RtMidi
     LINUX_ALSA,     /*!< The Advanced Linux Sound Architecture API. */
     UNIX_JACK,      /*!< The JACK Low-Latency MIDI Server API. */
     WINDOWS_MM,     /*!< The Microsoft Multimedia MIDI API. */
-    RTMIDI_DUMMY    /*!< A compilable but non-functional API. */
+    RTMIDI_DUMMY,   /*!< A compilable but non-functional API. */
+    LINUX_ALSA_RAW  /*!< ALSA rawmidi devices, hardware ports only, without the sequencer. */
   };
 
   //! A static function to determine the current RtMidi version.
@@ -258,6 +279,34 @@ class RtMidiIn : public RtMidi
   */
   void openVirtualPort( const std::string portName = std::string( "RtMidi Input" ) );
 
+  //! Additionally listen to another MIDI input port on the already opened connection.
+  /*!
+    All ports share the one connection and input thread opened by
+    openPort().  Messages are tagged with the index of their source,
+    see getMessageSource().  Currently only supported by the Linux
+    ALSA API (the function returns an error for the other APIs).
+    closePort() closes all ports.
+
+    \param portNumber The port number as enumerated by getPortName().
+  */
+  void addPort( unsigned int portNumber );
+
+  //! Returns the source of the message passed to the callback right now, or last returned by getMessage().
+  /*!
+    0 is the port opened by openPort(), 1 the first port added by
+    addPort() and so on.  -1 if the source is unknown, e.g. a client
+    connected to a virtual port.
+  */
+  int getMessageSource( void ) const;
+
+  //! Returns the arrival time of the message passed to the callback right now, or last returned by getMessage().
+  /*!
+    Nanoseconds on CLOCK_MONOTONIC, as taken from the ALSA sequencer
+    queue, so it can be compared with clock_gettime( CLOCK_MONOTONIC )
+    on the output side.  0 if the API does not provide it.
+  */
+  long long getMessageTime( void ) const;
+
   //! Set a callback function to be invoked for incoming MIDI messages.
   /*!
     The callback function will be called whenever an incoming MIDI
@@ -307,6 +356,64 @@ class RtMidiIn : public RtMidi
   */
   void ignoreTypes( bool midiSysex = true, bool midiTime = true, bool midiSense = true );
 
+  //! Specify the MIDI messages passed on, by status byte (type and channel).
+  /*!
+    \e filter points to RTMIDI_FILTER_WORDS words, bit (status & 31)
+    of word (status >> 5) accepts messages with that status byte.
+    NULL accepts all messages (the default).  With the Linux ALSA API
+    rejected events are dropped before they are decoded, event types
+    which are rejected on all channels are not even delivered by the
+    sequencer.  ignoreTypes() is applied in addition.
+  */
+  void setMessageFilter( const unsigned int *filter );
+
+  //! Set the size of the largest sysex message received, in bytes, including F0 and F7.
+  /*!
+    The ALSA APIs assemble sysex messages in a buffer of this size,
+    allocated once when the port is opened, so bulk dumps are received
+    without memory allocation on the input thread.  Without a
+    callback the slots of the message queue get this size, too.
+    Longer sysex messages are dropped as a whole.  Takes effect with the next
+    openPort() or openVirtualPort().  The default is
+    RTMIDI_DEFAULT_MAX_SYSEX.
+  */
+  void setMaxSysexSize( size_t size );
+
+  //! Return the number of messages lost because the input queue was full.
+  /*!
+    Only used without a callback, when messages are queued for
+    getMessage().  The queue holds \e queueSizeLimit messages, see
+    the constructor.
+  */
+  unsigned long getQueueOverflowCount( void ) const;
+
+  //! Return the number of sysex messages dropped by the input thread.
+  /*!
+    Counts sysex messages longer than setMaxSysexSize() and, with
+    several ports, unfinished ones which had to make room for another.
+    The input thread only counts, it does not print.
+  */
+  unsigned long getDroppedSysexCount( void ) const;
+
+  //! Return the number of failed reads of the input thread, e.g. after the device was unplugged.
+  unsigned long getInputErrorCount( void ) const;
+
+  //! Request real-time scheduling for the input thread.
+  /*!
+    A \e priority above 0 starts the input thread with SCHED_FIFO at
+    this priority (clamped to the range of the system), 0 keeps the
+    normal scheduling (the default).  A \e cpu of 0 or above pins the
+    thread to this CPU.  Takes effect with the next openPort() or
+    openVirtualPort().  If the user may not use real-time priorities
+    (no rtprio limit) or the CPU does not exist, the thread runs with
+    normal scheduling anyway and a warning is issued, see
+    isThreadRealtime().  Only the Linux ALSA APIs support this.
+  */
+  void setThreadPriority( int priority, int cpu = -1 );
+
+  //! Returns true if the running input thread got the requested real-time priority.
+  bool isThreadRealtime( void ) const;
+
   //! Fill the user-provided vector with the data bytes for the next available MIDI message in the input queue and return the event delta-time in seconds.
   /*!
     This function returns immediately whether a new message is
@@ -408,6 +515,43 @@ class RtMidiOut : public RtMidi
   */
   void sendMessage( std::vector<unsigned char> *message );
 
+  //! Immediately send a single message given by pointer and size out an open MIDI output port.
+  /*!
+      The data is not copied by APIs supporting it, so large sysex
+      buffers (e.g. memory mapped files) can be sent without
+      duplicating them.  An exception is thrown if an error occurs
+      during output or an output connection was not previously
+      established.
+  */
+  void sendMessage( const unsigned char *message, size_t size );
+
+  //! Immediately send several complete MIDI messages stored back to back, e.g. the content of a sysex file.
+  /*!
+      With the Linux ALSA API all messages are queued and handed to
+      the sequencer with a single drain.  Other APIs send them one by
+      one.  Running status is not supported, every message has to
+      start with its status byte.
+  */
+  void sendMessages( const unsigned char *messages, size_t size );
+
+  //! Wait until all data sent so far has left the output buffer of the driver.
+  /*!
+    Only the Linux ALSA rawmidi API queues output in the driver, send
+    calls return as soon as the data is buffered.  Call this to pace
+    messages or to know when the last byte is on the wire.  The cancel
+    callback ends the wait early.  Returns at once with other APIs.
+  */
+  void drain( void );
+
+  //! Set a function which can abort sendMessages() while it waits for the device.
+  /*!
+    sendMessages() stops between messages, or with the Linux ALSA
+    rawmidi API while the output buffer is full.  A sysex which was cut
+    is terminated with an end of exclusive byte.  Pass NULL to remove
+    the callback.
+  */
+  void setCancelCallback( RtMidiCancelCallback callback = NULL, void *userData = 0 );
+
   //! Set an error callback function to be invoked when an error has occured.
   /*!
     The callback function will be called whenever an error has occured. It is best
@@ -419,6 +563,41 @@ class RtMidiOut : public RtMidi
   void openMidiApi( RtMidi::Api api, const std::string clientName );
 };
 
+/**********************************************************************/
+/*! \class RtMidiPortWatcher
+    \brief Notifies when MIDI ports appear, change or disappear.
+
+    With the Linux ALSA API a thread listens to the announce port of
+    the sequencer and calls the callback whenever clients or ports were
+    started, changed or ended.  A burst of announcements (a device with
+    several ports) results in few calls.  The callback runs on the
+    watcher thread and should only schedule a new port enumeration.
+
+    Other APIs have no such notification, isWatching() returns false
+    and the ports have to be polled.
+*/
+/**********************************************************************/
+
+class RtMidiPortWatcher
+{
+ public:
+
+  //! User callback, called on the watcher thread.
+  typedef void (*RtMidiPortCallback)( void *userData );
+
+  //! Start watching, \e callback is called with \e userData.
+  RtMidiPortWatcher( RtMidiPortCallback callback, void *userData = 0 );
+
+  //! Stop watching, the callback is not called anymore after this returns.
+  ~RtMidiPortWatcher( void );
+
+  //! Returns true if port changes are notified.
+  bool isWatching( void ) const { return data_ != 0; }
+
+ private:
+  void *data_;
+};
+
 
 // **************************************************************** //
 //
@@ -474,28 +653,55 @@ class MidiInApi : public MidiApi
   void cancelCallback( void );
   virtual void ignoreTypes( bool midiSysex, bool midiTime, bool midiSense );
   double getMessage( std::vector<unsigned char> *message );
+  virtual void addPort( unsigned int portNumber );
+  virtual void setMessageFilter( const unsigned int *filter );
+  void setMaxSysexSize( size_t size );
+  void setThreadPriority( int priority, int cpu );
+  inline bool isThreadRealtime( void ) const { return inputData_.threadRealtime; }
+  inline int getMessageSource( void ) const { return inputData_.source; }
+  inline long long getMessageTime( void ) const { return inputData_.time; }
+  inline unsigned long getQueueOverflowCount( void ) const { return inputData_.queue.overflows.load( std::memory_order_relaxed ); }
+  inline unsigned long getDroppedSysexCount( void ) const { return inputData_.sysexDrops.load( std::memory_order_relaxed ); }
+  inline unsigned long getInputErrorCount( void ) const { return inputData_.inputErrors.load( std::memory_order_relaxed ); }
 
   // A MIDI structure used internally by the class to store incoming
   // messages.  Each message represents one and only one MIDI message.
   struct MidiMessage { 
     std::vector<unsigned char> bytes; 
     double timeStamp;
+    int source;
+    long long time;
 
     // Default constructor.
   MidiMessage()
-  :bytes(0), timeStamp(0.0) {}
+  :bytes(0), timeStamp(0.0), source(0), time(0) {}
   };
 
+  // Lock-free ring from the input thread (the only producer) to
+  // getMessage() (the only consumer).  One slot always stays free, so
+  // front == back means empty.  Messages are copied into and out of
+  // the slots, which are preallocated by reserve() and keep their
+  // capacity, so neither side allocates.
   struct MidiQueue {
-    unsigned int front;
-    unsigned int back;
-    unsigned int size;
+    // Written by the consumer only.  Padding instead of alignas, the
+    // queue is allocated with plain new.
+    std::atomic<unsigned int> front;
+    char frontPad[RTMIDI_CACHE_LINE];
+    // Written by the producer only
+    std::atomic<unsigned int> back;
+    std::atomic<unsigned long> overflows;
+    char backPad[RTMIDI_CACHE_LINE];
+    // Set up before the input thread starts
     unsigned int ringSize;
     MidiMessage *ring;
 
     // Default constructor.
   MidiQueue()
-  :front(0), back(0), size(0), ringSize(0) {}
+  :front(0), back(0), overflows(0), ringSize(0), ring(0) {}
+
+    bool push( const MidiMessage &message );
+    bool pop( MidiMessage &message );
+    void reserve( size_t size );
   };
 
   // The RtMidiInData structure is used to pass private class data to
@@ -511,12 +717,26 @@ class MidiInApi : public MidiApi
     RtMidiIn::RtMidiCallback userCallback;
     void *userData;
     bool continueSysex;
+    int source;
+    long long time;
+    unsigned int filter[RTMIDI_FILTER_WORDS];
+    size_t maxSysexSize;
+    int threadPriority;
+    int threadCpu;
+    bool threadRealtime;
+    // Written by the input thread only
+    std::atomic<unsigned long> sysexDrops;
+    std::atomic<unsigned long> inputErrors;
 
     // Default constructor.
   RtMidiInData()
   : ignoreFlags(7), doInput(false), firstMessage(true),
       apiData(0), usingCallback(false), userCallback(0), userData(0),
-      continueSysex(false) {}
+      continueSysex(false), source(0), time(0), maxSysexSize(RTMIDI_DEFAULT_MAX_SYSEX),
+      threadPriority(0), threadCpu(-1), threadRealtime(false), sysexDrops(0), inputErrors(0) { for ( int i = 0; i < RTMIDI_FILTER_WORDS; i++ ) filter[i] = 0xFFFFFFFF; }
+
+    // Is a message with this status byte passed on?
+    inline bool accepts( unsigned char status ) const { return ( filter[status >> 5] >> ( status & 0x1F ) ) & 1; }
   };
 
  protected:
@@ -529,7 +749,20 @@ class MidiOutApi : public MidiApi
 
   MidiOutApi( void );
   virtual ~MidiOutApi( void );
-  virtual void sendMessage( std::vector<unsigned char> *message ) = 0;
+  void sendMessage( std::vector<unsigned char> *message );
+  virtual void sendMessage( const unsigned char *message, size_t size ) = 0;
+  virtual void sendMessages( const unsigned char *messages, size_t size );
+  virtual void drain( void ) {}
+  void setCancelCallback( RtMidiCancelCallback callback, void *userData );
+
+  //! Length of the MIDI message at the start of \e message, at most \e size.
+  static size_t messageLength( const unsigned char *message, size_t size );
+
+ protected:
+  bool isCancelled( void ) { return cancelCallback_ && cancelCallback_( cancelUserData_ ); }
+
+  RtMidiCancelCallback cancelCallback_;
+  void *cancelUserData_;
 };
 
 // **************************************************************** //
@@ -541,6 +774,9 @@ class MidiOutApi : public MidiApi
 inline RtMidi::Api RtMidiIn :: getCurrentApi( void ) throw() { return rtapi_->getCurrentApi(); }
 inline void RtMidiIn :: openPort( unsigned int portNumber, const std::string portName ) { rtapi_->openPort( portNumber, portName ); }
 inline void RtMidiIn :: openVirtualPort( const std::string portName ) { rtapi_->openVirtualPort( portName ); }
+inline void RtMidiIn :: addPort( unsigned int portNumber ) { ((MidiInApi *)rtapi_)->addPort( portNumber ); }
+inline int RtMidiIn :: getMessageSource( void ) const { return ((MidiInApi *)rtapi_)->getMessageSource(); }
+inline long long RtMidiIn :: getMessageTime( void ) const { return ((MidiInApi *)rtapi_)->getMessageTime(); }
 inline void RtMidiIn :: closePort( void ) { rtapi_->closePort(); }
 inline bool RtMidiIn :: isPortOpen() const { return rtapi_->isPortOpen(); }
 inline void RtMidiIn :: setCallback( RtMidiCallback callback, void *userData ) { ((MidiInApi *)rtapi_)->setCallback( callback, userData ); }
@@ -548,6 +784,13 @@ inline void RtMidiIn :: cancelCallback( void ) { ((MidiInApi *)rtapi_)->cancelCa
 inline unsigned int RtMidiIn :: getPortCount( void ) { return rtapi_->getPortCount(); }
 inline std::string RtMidiIn :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
 inline void RtMidiIn :: ignoreTypes( bool midiSysex, bool midiTime, bool midiSense ) { ((MidiInApi *)rtapi_)->ignoreTypes( midiSysex, midiTime, midiSense ); }
+inline void RtMidiIn :: setMessageFilter( const unsigned int *filter ) { ((MidiInApi *)rtapi_)->setMessageFilter( filter ); }
+inline void RtMidiIn :: setMaxSysexSize( size_t size ) { ((MidiInApi *)rtapi_)->setMaxSysexSize( size ); }
+inline unsigned long RtMidiIn :: getQueueOverflowCount( void ) const { return ((MidiInApi *)rtapi_)->getQueueOverflowCount(); }
+inline unsigned long RtMidiIn :: getDroppedSysexCount( void ) const { return ((MidiInApi *)rtapi_)->getDroppedSysexCount(); }
+inline unsigned long RtMidiIn :: getInputErrorCount( void ) const { return ((MidiInApi *)rtapi_)->getInputErrorCount(); }
+inline void RtMidiIn :: setThreadPriority( int priority, int cpu ) { ((MidiInApi *)rtapi_)->setThreadPriority( priority, cpu ); }
+inline bool RtMidiIn :: isThreadRealtime( void ) const { return ((MidiInApi *)rtapi_)->isThreadRealtime(); }
 inline double RtMidiIn :: getMessage( std::vector<unsigned char> *message ) { return ((MidiInApi *)rtapi_)->getMessage( message ); }
 inline void RtMidiIn :: setErrorCallback( RtMidiErrorCallback errorCallback, void *userData ) { rtapi_->setErrorCallback(errorCallback, userData); }
 
@@ -559,6 +802,12 @@ inline bool RtMidiOut :: isPortOpen() const { return rtapi_->isPortOpen(); }
 inline unsigned int RtMidiOut :: getPortCount( void ) { return rtapi_->getPortCount(); }
 inline std::string RtMidiOut :: getPortName( unsigned int portNumber ) { return rtapi_->getPortName( portNumber ); }
 inline void RtMidiOut :: sendMessage( std::vector<unsigned char> *message ) { ((MidiOutApi *)rtapi_)->sendMessage( message ); }
+inline void MidiOutApi :: sendMessage( std::vector<unsigned char> *message ) { sendMessage( message->empty() ? 0 : &message->at(0), message->size() ); }
+inline void RtMidiOut :: sendMessage( const unsigned char *message, size_t size ) { ((MidiOutApi *)rtapi_)->sendMessage( message, size ); }
+inline void RtMidiOut :: sendMessages( const unsigned char *messages, size_t size ) { ((MidiOutApi *)rtapi_)->sendMessages( messages, size ); }
+inline void RtMidiOut :: drain( void ) { ((MidiOutApi *)rtapi_)->drain(); }
+inline void RtMidiOut :: setCancelCallback( RtMidiCancelCallback callback, void *userData ) { ((MidiOutApi *)rtapi_)->setCancelCallback( callback, userData ); }
+inline void MidiOutApi :: setCancelCallback( RtMidiCancelCallback callback, void *userData ) { cancelCallback_ = callback; cancelUserData_ = userData; }
 inline void RtMidiOut :: setErrorCallback( RtMidiErrorCallback errorCallback, void *userData ) { rtapi_->setErrorCallback(errorCallback, userData); }
 
 // **************************************************************** //
@@ -600,7 +849,7 @@ class MidiOutCore: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   void initialize( const std::string& clientName );
@@ -640,7 +889,7 @@ class MidiOutJack: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   std::string clientName;
@@ -661,9 +910,11 @@ class MidiInAlsa: public MidiInApi
   RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA; };
   void openPort( unsigned int portNumber, const std::string portName );
   void openVirtualPort( const std::string portName );
+  void addPort( unsigned int portNumber );
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
+  void setMessageFilter( const unsigned int *filter );
 
  protected:
   void initialize( const std::string& clientName );
@@ -680,7 +931,43 @@ class MidiOutAlsa: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
+  void sendMessages( const unsigned char *messages, size_t size );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiInAlsaRaw: public MidiInApi
+{
+ public:
+  MidiInAlsaRaw( const std::string clientName, unsigned int queueSizeLimit );
+  ~MidiInAlsaRaw( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA_RAW; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+
+ protected:
+  void initialize( const std::string& clientName );
+};
+
+class MidiOutAlsaRaw: public MidiOutApi
+{
+ public:
+  MidiOutAlsaRaw( const std::string clientName );
+  ~MidiOutAlsaRaw( void );
+  RtMidi::Api getCurrentApi( void ) { return RtMidi::LINUX_ALSA_RAW; };
+  void openPort( unsigned int portNumber, const std::string portName );
+  void openVirtualPort( const std::string portName );
+  void closePort( void );
+  unsigned int getPortCount( void );
+  std::string getPortName( unsigned int portNumber );
+  void sendMessage( const unsigned char *message, size_t size );
+  void sendMessages( const unsigned char *messages, size_t size );
+  void drain( void );
 
  protected:
   void initialize( const std::string& clientName );
@@ -717,7 +1004,7 @@ class MidiOutWinMM: public MidiOutApi
   void closePort( void );
   unsigned int getPortCount( void );
   std::string getPortName( unsigned int portNumber );
-  void sendMessage( std::vector<unsigned char> *message );
+  void sendMessage( const unsigned char *message, size_t size );
 
  protected:
   void initialize( const std::string& clientName );
@@ -752,7 +1039,7 @@ class MidiOutDummy: public MidiOutApi
   void closePort( void ) {}
   unsigned int getPortCount( void ) { return 0; }
   std::string getPortName( unsigned int /*portNumber*/ ) { return ""; }
-  void sendMessage( std::vector<unsigned char> * /*message*/ ) {}
+  void sendMessage( const unsigned char * /*message*/, size_t /*size*/ ) {}
 
  protected:
   void initialize( const std::string& /*clientName*/ ) {}
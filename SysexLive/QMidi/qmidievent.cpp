@@ -0,0 +1,62 @@
+#include "qmidievent.h"
+
+QMidiSysexPool::QMidiSysexPool() :
+    _dropped(0)
+{
+    //Allocate everything up front, the MIDI thread should not have to
+    for(int i = 0; i < QMIDI_SYSEX_POOL_SIZE; i++)
+    {
+        _buffers[i].refCount.store(0);
+        _buffers[i].data.reserve(QMIDI_SYSEX_BUFFER_SIZE);
+    }
+}
+
+//Grow all buffers up front to the largest sysex expected. Only while no input is running.
+void QMidiSysexPool::reserve(size_t size)
+{
+    for(int i = 0; i < QMIDI_SYSEX_POOL_SIZE; i++)
+    {
+        _buffers[i].data.reserve(size);
+    }
+}
+
+//Copy a sysex into a free buffer, owned by the caller with one reference. Returns -1 if all buffers are in use.
+int QMidiSysexPool::acquire(const unsigned char *data, size_t size)
+{
+    for(int i = 0; i < QMIDI_SYSEX_POOL_SIZE; i++)
+    {
+        if(!_buffers[i].refCount.testAndSetAcquire(0, 1)) continue;
+        //Only reallocates if this is the biggest sysex the buffer has seen
+        _buffers[i].data.assign(data, data + size);
+        return i;
+    }
+    _dropped.fetchAndAddRelaxed(1);
+    return -1;
+}
+
+void QMidiSysexPool::retain(int buffer)
+{
+    _buffers[buffer].refCount.ref();
+}
+
+//Buffer gets reused after the last reference is gone
+void QMidiSysexPool::release(int buffer)
+{
+    _buffers[buffer].refCount.deref();
+}
+
+const unsigned char *QMidiSysexPool::data(int buffer) const
+{
+    return _buffers[buffer].data.empty() ? 0 : &_buffers[buffer].data[0];
+}
+
+size_t QMidiSysexPool::size(int buffer) const
+{
+    return _buffers[buffer].data.size();
+}
+
+//Number of sysex messages lost because all buffers were in use
+int QMidiSysexPool::dropped() const
+{
+    return _dropped.load();
+}
@@ -0,0 +1,162 @@
+#ifndef QMIDIEVENT_H
+#define QMIDIEVENT_H
+
+#include <QMetaType>
+#include <QAtomicInt>
+#include <vector>
+#include <chrono>
+#include <time.h>
+#include "qmidimessage.h"
+
+//Number of sysex messages which may be in flight at the same time
+#define QMIDI_SYSEX_POOL_SIZE 16
+//Initial capacity of each pooled sysex buffer, grows once if a bigger sysex arrives
+#define QMIDI_SYSEX_BUFFER_SIZE 1024
+
+//Reusable buffers for incoming sysex, refcounted so they can be used without copies
+class QMidiSysexPool
+{
+public:
+    QMidiSysexPool();
+    void reserve(size_t size);
+    int acquire(const unsigned char *data, size_t size);
+    void retain(int buffer);
+    void release(int buffer);
+    const unsigned char *data(int buffer) const;
+    size_t size(int buffer) const;
+    int dropped() const;
+
+private:
+    struct Buffer
+    {
+        QAtomicInt refCount;
+        std::vector<unsigned char> data;
+    };
+    Buffer _buffers[QMIDI_SYSEX_POOL_SIZE];
+    QAtomicInt _dropped;
+    Q_DISABLE_COPY(QMidiSysexPool)
+};
+
+//One incoming MIDI message. Trivially copyable, so it is passed by value without any allocation.
+struct QMidiEvent
+{
+    QMidiEvent() :
+        status(MIDI_UNKNOWN), channel(0), data1(0), data2(0), size(0),
+        deltaTime(0), timestamp(0), emitTimestamp(0),
+        sysexPool(0), sysexBuffer(-1), handled(false), source(0)
+    {
+    }
+
+    QMidiStatus getStatus() const
+    {
+        return status;
+    }
+    unsigned int getChannel() const
+    {
+        return channel;
+    }
+    unsigned int getPitch() const
+    {
+        return data1;
+    }
+    unsigned int getVelocity() const
+    {
+        return data2;
+    }
+    unsigned int getControl() const
+    {
+        return data1;
+    }
+    unsigned int getValue() const
+    {
+        switch(status)
+        {
+        case MIDI_PROGRAM_CHANGE:
+        case MIDI_AFTERTOUCH:
+            return data1;
+        case MIDI_PITCH_BEND:
+            return (data2 << 7) + data1; // msb + lsb
+        default:
+            return data2;
+        }
+    }
+    double getDeltaTime() const
+    {
+        return deltaTime;
+    }
+    //ns on the clock of currentTimestamp(), when the message arrived: from the driver if it tells, else when the input callback ran
+    qint64 getTimestamp() const
+    {
+        return timestamp;
+    }
+    //ns on the clock of currentTimestamp(), when the message was handed over to the receiver thread
+    qint64 getEmitTimestamp() const
+    {
+        return emitTimestamp;
+    }
+
+    //Already handled on the MIDI thread by a QMidiInHandler
+    bool isHandled() const
+    {
+        return handled;
+    }
+
+    //Input port the event came from, see QMidiIn::sourceName()
+    int getSource() const
+    {
+        return source;
+    }
+
+    //Sysex data, valid while the receiving slot runs or after retainSysex()
+    bool hasSysex() const
+    {
+        return sysexBuffer >= 0;
+    }
+    const unsigned char *sysexData() const
+    {
+        return hasSysex() ? sysexPool->data(sysexBuffer) : 0;
+    }
+    size_t sysexSize() const
+    {
+        return hasSysex() ? sysexPool->size(sysexBuffer) : 0;
+    }
+    //Keep the sysex data beyond the receiving slot, balance with releaseSysex()
+    void retainSysex() const
+    {
+        if(hasSysex()) sysexPool->retain(sysexBuffer);
+    }
+    void releaseSysex() const
+    {
+        if(hasSysex()) sysexPool->release(sysexBuffer);
+    }
+
+    //Monotonic time in ns, same clock for all threads. On Linux CLOCK_MONOTONIC, like the ALSA input timestamps.
+    static qint64 currentTimestamp()
+    {
+#ifdef Q_OS_LINUX
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (qint64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch() ).count();
+#endif
+    }
+
+    QMidiStatus status;
+    unsigned char channel;
+    unsigned char data1;
+    unsigned char data2;
+    unsigned char size;
+    double deltaTime;
+    qint64 timestamp;
+    qint64 emitTimestamp;
+    QMidiSysexPool *sysexPool;
+    int sysexBuffer;
+    bool handled;
+    int source;
+};
+
+Q_DECLARE_METATYPE(QMidiEvent)
+
+#endif // QMIDIEVENT_H
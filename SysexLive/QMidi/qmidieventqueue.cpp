@@ -0,0 +1,64 @@
+#include "qmidieventqueue.h"
+
+QMidiEventQueue::QMidiEventQueue() :
+    _head(0),
+    _tail(0),
+    _highWater(0),
+    _overruns(0)
+{
+}
+
+//Producer side. Returns false and counts an overrun if the consumer is too slow.
+bool QMidiEventQueue::push(const QMidiEvent &event)
+{
+    quint32 head = _head.load();
+    quint32 tail = _tail.loadAcquire();
+    int fill = (int)(head - tail);
+    if(fill >= QMIDI_EVENT_QUEUE_SIZE)
+    {
+        _overruns.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    _events[head & (QMIDI_EVENT_QUEUE_SIZE - 1)] = event;
+    _head.storeRelease(head + 1);
+
+    //Only the producer raises it, a plain store is enough
+    if(fill + 1 > _highWater.load()) _highWater.store(fill + 1);
+    return true;
+}
+
+//Consumer side. Returns false if the queue is empty.
+bool QMidiEventQueue::pop(QMidiEvent &event)
+{
+    quint32 tail = _tail.load();
+    if(tail == _head.loadAcquire()) return false;
+
+    event = _events[tail & (QMIDI_EVENT_QUEUE_SIZE - 1)];
+    _tail.storeRelease(tail + 1);
+    return true;
+}
+
+//Events waiting right now
+int QMidiEventQueue::fill() const
+{
+    return (int)(_head.loadAcquire() - _tail.loadAcquire());
+}
+
+//Highest fill level seen since the last reset
+int QMidiEventQueue::highWater() const
+{
+    return _highWater.load();
+}
+
+//Events lost because the queue was full
+int QMidiEventQueue::overruns() const
+{
+    return _overruns.load();
+}
+
+void QMidiEventQueue::resetStatistics()
+{
+    _highWater.store(0);
+    _overruns.store(0);
+}
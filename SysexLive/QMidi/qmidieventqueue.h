@@ -0,0 +1,42 @@
+#ifndef QMIDIEVENTQUEUE_H
+#define QMIDIEVENTQUEUE_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include "qmidievent.h"
+
+//Number of events the queue can hold, must be a power of two
+#define QMIDI_EVENT_QUEUE_SIZE 1024
+//Events handled per wake-up before the receiving thread gets back to its other work
+#define QMIDI_EVENT_BATCH_SIZE 256
+//Bytes between members written by different threads
+#define QMIDI_CACHE_LINE 64
+
+//Lock-free single producer / single consumer ring for incoming events.
+//The MIDI thread pushes, the thread of QMidiIn pops. No allocation after construction.
+class QMidiEventQueue
+{
+public:
+    QMidiEventQueue();
+    bool push(const QMidiEvent &event);
+    bool pop(QMidiEvent &event);
+    int fill() const;
+    int highWater() const;
+    int overruns() const;
+    void resetStatistics();
+
+private:
+    QMidiEvent _events[QMIDI_EVENT_QUEUE_SIZE];
+    //Producer and consumer indices on their own cache lines, they are written by different threads.
+    //Padding instead of alignas: QMidiIn is created with plain new, which does not honour extended alignment.
+    char _eventsPad[QMIDI_CACHE_LINE];
+    QAtomicInteger<quint32> _head;
+    char _headPad[QMIDI_CACHE_LINE];
+    QAtomicInteger<quint32> _tail;
+    char _tailPad[QMIDI_CACHE_LINE];
+    QAtomicInt _highWater;
+    QAtomicInt _overruns;
+    Q_DISABLE_COPY(QMidiEventQueue)
+};
+
+#endif // QMIDIEVENTQUEUE_H
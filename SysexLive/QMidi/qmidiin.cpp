@@ -1,11 +1,30 @@
 #include "qmidiin.h"
-#include <QDebug>
+#include "qmiditrace.h"
+#include "qmidiportregistry.h"
+
+RtMidi::Api QMidiIn::_defaultApi = RtMidi::UNSPECIFIED;
+
 QMidiIn::QMidiIn(QObject *parent) : QObject(parent),
-    _midiIn(new RtMidiIn())
+    _midiIn(new RtMidiIn(_defaultApi)),
+    _drainPending(0),
+    _handler(0),
+    _registry(0)
 {
+    qRegisterMetaType<QMidiEvent>("QMidiEvent");
     _midiIn->setCallback(&QMidiIn::callback, this);
 }
 
+//API used by QMidiIn objects created from now on, UNSPECIFIED lets RtMidi choose
+void QMidiIn::setDefaultApi(RtMidi::Api api)
+{
+    _defaultApi = api;
+}
+
+RtMidi::Api QMidiIn::defaultApi()
+{
+    return _defaultApi;
+}
+
 QStringList QMidiIn::getPorts()
 {
     //TODO: make this static
@@ -20,11 +39,13 @@ QStringList QMidiIn::getPorts()
 void QMidiIn::closePort()
 {
     _midiIn->closePort();
+    _sourceNames.clear();
 }
 
 void QMidiIn::openPort(unsigned int index)
 {
     _midiIn->openPort(index);
+    _sourceNames = QStringList(QString::fromStdString(_midiIn->getPortName(index)));
 }
 
 void QMidiIn::openVirtualPort(QString name)
@@ -34,14 +55,59 @@ void QMidiIn::openVirtualPort(QString name)
 
 void QMidiIn::openPort(QString name)
 {
+    int index = findPort(name);
+    if(index < 0) return;
+    _midiIn->openPort(index);
+    _sourceNames = QStringList(name);
+}
+
+//Listen to one more port on the opened connection, served by the same MIDI thread
+bool QMidiIn::addPort(QString name)
+{
+    //Only ALSA can subscribe several ports to one connection
+    if(_midiIn->getCurrentApi() != RtMidi::LINUX_ALSA) return false;
+    if(!_midiIn->isPortOpen() || _sourceNames.contains(name)) return false;
+    int index = findPort(name);
+    if(index < 0) return false;
+    _midiIn->addPort(index);
+    _sourceNames.append(name);
+    return true;
+}
+
+//Look up ports by name in this registry instead of enumerating them. Must use the same API.
+void QMidiIn::setPortRegistry(QMidiPortRegistry *registry)
+{
+    _registry = registry;
+}
+
+//Index of the port with this name, -1 if not found
+int QMidiIn::findPort(const QString &name)
+{
+    //The registry may not have seen the latest change yet: trust its index only if the driver agrees
+    if(_registry)
+    {
+        int index = _registry->inputIndex(name);
+        if(index < 0 || isPortName(index, name)) return index;
+    }
     for(unsigned int i = 0; i < _midiIn->getPortCount(); i++)
     {
-        if(name == QString::fromStdString(_midiIn->getPortName(i)))
-        {
-            _midiIn->openPort(i);
-            return;
-        }
+        if(name == QString::fromStdString(_midiIn->getPortName(i))) return i;
     }
+    return -1;
+}
+
+//Has the port at this index (still) this name?
+bool QMidiIn::isPortName(unsigned int index, const QString &name)
+{
+    if(index >= _midiIn->getPortCount()) return false;
+    return name == QString::fromStdString(_midiIn->getPortName(index));
+}
+
+//Name of the port an event came from, QMidiEvent::getSource()
+QString QMidiIn::sourceName(int source)
+{
+    if(source < 0 || source >= _sourceNames.size()) return QString();
+    return _sourceNames.at(source);
 }
 
 void QMidiIn::setIgnoreTypes(bool sysex, bool time, bool sense)
@@ -49,68 +115,179 @@ void QMidiIn::setIgnoreTypes(bool sysex, bool time, bool sense)
     _midiIn->ignoreTypes(sysex, time, sense);
 }
 
+//Pass on only these types, channel messages only on the channels set in channels (bit 0 = channel 1).
+//Everything else is dropped on the MIDI thread before decoding. An empty list passes on everything.
+void QMidiIn::setMessageFilter(const QList<QMidiStatus> &types, quint16 channels)
+{
+    if(types.isEmpty())
+    {
+        _midiIn->setMessageFilter(0);
+        return;
+    }
+
+    unsigned int filter[RTMIDI_FILTER_WORDS] = { 0 };
+    foreach(QMidiStatus type, types)
+    {
+        if(type >= MIDI_SYSEX)
+        {
+            filter[type >> 5] |= 1u << (type & 0x1F);
+            continue;
+        }
+        for(int channel = 0; channel < 16; channel++)
+        {
+            if(!(channels & (1 << channel))) continue;
+            unsigned int status = (type & 0xF0) | channel;
+            filter[status >> 5] |= 1u << (status & 0x1F);
+        }
+    }
+    _midiIn->setMessageFilter(filter);
+}
+
+//Largest sysex received, longer ones are dropped. All buffers are allocated now, call before openPort().
+void QMidiIn::setMaxSysexSize(size_t size)
+{
+    _midiIn->setMaxSysexSize(size);
+    _sysexPool.reserve(size);
+}
+
+//SCHED_FIFO priority (0 = normal scheduling) and CPU (-1 = any) of the MIDI thread, used from the next openPort() on
+void QMidiIn::setRealtime(int priority, int cpu)
+{
+    _midiIn->setThreadPriority(priority, cpu);
+}
+
+//Did the MIDI thread get its real-time priority? False if the user lacks the rtprio permission.
+bool QMidiIn::isRealtime()
+{
+    return _midiIn->isThreadRealtime();
+}
+
 bool QMidiIn::isPortOpen()
 {
     return _midiIn->isPortOpen();
 }
 
-void QMidiIn::onMidiMessageReceive(QMidiMessage *msg)
+//Sysex lost because all buffers were in use or, in the driver, because it was too long
+int QMidiIn::droppedSysex()
 {
-    msg->moveToThread(thread());
-    emit midiMessageReceived(msg);
+    return _sysexPool.dropped() + (int)_midiIn->getDroppedSysexCount();
 }
 
-void QMidiIn::callback(double deltatime, std::vector<unsigned char> *message, void *userData)
+//Failed reads of the MIDI thread, e.g. the device was unplugged while open
+int QMidiIn::inputErrors()
 {
-    QMidiIn* midiIn = (QMidiIn*) userData;
-    QMidiMessage *midiMessage = new QMidiMessage();
-
-        if((message->at(0)) >= MIDI_SYSEX) {
-            midiMessage->setStatus((QMidiStatus)(message->at(0) & 0xFF));
-            midiMessage->setChannel(0);
-        } else {
-            midiMessage->setStatus((QMidiStatus) (message->at(0) & 0xF0));
-            midiMessage->setChannel((message->at(0) & 0x0F)+1);
-        }
+    return (int)_midiIn->getInputErrorCount();
+}
+
+//Events waiting for the thread of QMidiIn right now
+int QMidiIn::eventQueueFill()
+{
+    return _eventQueue.fill();
+}
+
+//Highest number of waiting events seen
+int QMidiIn::eventQueueHighWater()
+{
+    return _eventQueue.highWater();
+}
 
-        midiMessage->setDeltaTime(deltatime*1000); //convert s to ms
-//        midiMessage->portNum = portNum;
-//        midiMessage->portName = portName;
-
-        switch(midiMessage->getStatus()) {
-            case MIDI_NOTE_ON :
-            case MIDI_NOTE_OFF:
-                midiMessage->setPitch((unsigned int) message->at(1));
-                midiMessage->setVelocity((unsigned int) message->at(2));
-                break;
-            case MIDI_CONTROL_CHANGE:
-                midiMessage->setControl((unsigned int) message->at(1));
-                midiMessage->setValue((unsigned int) message->at(2));
-                break;
-            case MIDI_PROGRAM_CHANGE:
-            case MIDI_AFTERTOUCH:
-                midiMessage->setValue((unsigned int) message->at(1));
-                break;
-            case MIDI_PITCH_BEND:
-                midiMessage->setValue((unsigned int) (message->at(2) << 7) +
-                                    (unsigned int) message->at(1)); // msb + lsb
-                break;
-            case MIDI_POLY_AFTERTOUCH:
-                midiMessage->setPitch((unsigned int) message->at(1));
-                midiMessage->setValue((unsigned int) message->at(2));
-                break;
-            default:
-                break;
+//Events lost because the receiving thread was too slow
+int QMidiIn::eventQueueOverruns()
+{
+    return _eventQueue.overruns();
+}
+
+void QMidiIn::resetEventQueueStatistics()
+{
+    _eventQueue.resetStatistics();
+}
+
+//Handler for the MIDI thread, 0 to deliver everything through midiEventReceived() only
+void QMidiIn::setHandler(QMidiInHandler *handler)
+{
+    _handler.storeRelease(handler);
+}
+
+//Runs in the thread of QMidiIn, receivers there are called directly
+void QMidiIn::drainEvents()
+{
+    //Cleared before draining, so an event pushed meanwhile wakes us again instead of being missed
+    _drainPending.storeRelease(0);
+
+    QMidiEvent event;
+    int count = 0;
+    while(_eventQueue.pop(event))
+    {
+        emit midiEventReceived(event);
+        //Receivers are done, buffer can be reused unless one of them retained it
+        event.releaseSysex();
+
+        //Dense controller streams must not block the GUI, continue in the next round
+        if(++count == QMIDI_EVENT_BATCH_SIZE)
+        {
+            if(_drainPending.testAndSetOrdered(0, 1)) QMetaObject::invokeMethod(this, "drainEvents", Qt::QueuedConnection);
+            return;
         }
+    }
+}
 
+void QMidiIn::callback(double deltatime, std::vector<unsigned char> *message, void *userData)
+{
+    qint64 timestamp = QMidiEvent::currentTimestamp();
+    QMidiIn* midiIn = (QMidiIn*) userData;
     unsigned int nBytes = message->size();
-    qDebug()<<"channel"<<(int)(message->at(0))-144;
-    for ( unsigned int i=0; i<nBytes; i++ )
-      std::cout << "Byte " << i << " = " << (int)message->at(i) << ", ";
-    if ( nBytes > 0 )
-      std::cout << "stamp = " << deltatime << std::endl;
+    if(nBytes == 0) return;
 
-    midiIn->onMidiMessageReceive(midiMessage);
+    //Built on the stack, nothing is allocated per message
+    QMidiEvent event;
+    //Arrival time from the driver is more precise, it does not include the way to this thread
+    qint64 driverTimestamp = midiIn->_midiIn->getMessageTime();
+    event.timestamp = driverTimestamp > 0 ? driverTimestamp : timestamp;
+    event.deltaTime = deltatime*1000; //convert s to ms
+    event.source = midiIn->_midiIn->getMessageSource();
 
-}
+    if((message->at(0)) >= MIDI_SYSEX) {
+        event.status = (QMidiStatus)(message->at(0) & 0xFF);
+        event.channel = 0;
+    } else {
+        event.status = (QMidiStatus)(message->at(0) & 0xF0);
+        event.channel = (message->at(0) & 0x0F)+1;
+    }
+    if(nBytes > 1) event.data1 = message->at(1);
+    if(nBytes > 2) event.data2 = message->at(2);
+    event.size = nBytes > 3 ? 3 : nBytes;
+
+    //No formatted output on this thread, it is real-time
+    QMIDI_TRACE_EVENT(QMidiTrace::In, &message->at(0), nBytes);
+
+    //Fast path, e.g. start sending patches without waiting for the GUI
+    QMidiInHandler *handler = midiIn->_handler.loadAcquire();
+    if(handler && event.status == MIDI_PROGRAM_CHANGE) event.handled = handler->programChange(event);
+    else if(handler && event.status == MIDI_CONTROL_CHANGE) handler->controlChange(event);
 
+    //Sysex goes into a pooled buffer, the event only carries its handle
+    if(event.status == MIDI_SYSEX)
+    {
+        int buffer = midiIn->_sysexPool.acquire(&message->at(0), nBytes);
+        if(buffer < 0)
+        {
+            QMIDI_TRACE_EVENT(QMidiTrace::InSysexDropped, &message->at(0), nBytes);
+            return;
+        }
+        event.sysexPool = &midiIn->_sysexPool;
+        event.sysexBuffer = buffer;
+    }
+
+    event.emitTimestamp = QMidiEvent::currentTimestamp();
+    if(!midiIn->_eventQueue.push(event))
+    {
+        QMIDI_TRACE_EVENT(QMidiTrace::InOverrun, &message->at(0), nBytes);
+        event.releaseSysex();
+        return;
+    }
+    //Wake the receiving thread only if it is not already about to drain
+    if(midiIn->_drainPending.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(midiIn, "drainEvents", Qt::QueuedConnection);
+    }
+}
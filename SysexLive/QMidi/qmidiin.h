@@ -4,30 +4,70 @@
 #include <QStringList>
 #include <QObject>
 #include "RtMidi.h"
-#include "qmidimessage.h"
+#include "qmidievent.h"
+#include "qmidieventqueue.h"
 
+class QMidiPortRegistry;
+
+//Handles time critical messages directly on the MIDI thread, before they are queued.
+//Must not block. Return true if the message was handled, the event is delivered anyway.
+class QMidiInHandler
+{
+public:
+    virtual ~QMidiInHandler() {}
+    virtual bool programChange(const QMidiEvent &event) = 0;
+    virtual void controlChange(const QMidiEvent &event) { Q_UNUSED(event); }
+};
 
 class QMidiIn : public QObject
 {
     Q_OBJECT
 public:
     explicit QMidiIn(QObject *parent = 0);
+    static void setDefaultApi(RtMidi::Api api);
+    static RtMidi::Api defaultApi();
     QStringList getPorts();
     void closePort();
     void openPort(QString name);
     void openPort(unsigned int index);
     void openVirtualPort(QString name);
+    bool addPort(QString name);
+    QString sourceName(int source);
     void setIgnoreTypes(bool sysex = true, bool time = true, bool sense = true);
+    void setMessageFilter(const QList<QMidiStatus> &types, quint16 channels = 0xFFFF);
+    void setMaxSysexSize(size_t size);
+    void setRealtime(int priority, int cpu = -1);
+    bool isRealtime();
     bool isPortOpen();
+    int droppedSysex();
+    int inputErrors();
+    int eventQueueFill();
+    int eventQueueHighWater();
+    int eventQueueOverruns();
+    void resetEventQueueStatistics();
+    void setHandler(QMidiInHandler *handler);
+    void setPortRegistry(QMidiPortRegistry *registry);
 private:
-    void onMidiMessageReceive(QMidiMessage *msg);
+    int findPort(const QString &name);
+    bool isPortName(unsigned int index, const QString &name);
     static void callback( double deltatime, std::vector< unsigned char > *message, void *userData );
+    static RtMidi::Api _defaultApi;
 
 private:
     RtMidiIn *_midiIn;
+    QStringList _sourceNames;
+    QMidiSysexPool _sysexPool;
+    QMidiEventQueue _eventQueue;
+    QAtomicInt _drainPending;
+    QAtomicPointer<QMidiInHandler> _handler;
+    QMidiPortRegistry *_registry;
 
 signals:
-    void midiMessageReceived(QMidiMessage *message);
+    //Sysex data of the event is valid while the connected slot runs, see QMidiEvent::retainSysex()
+    void midiEventReceived(QMidiEvent event);
+
+private slots:
+    void drainEvents();
 
 public slots:
 };
@@ -15,7 +15,7 @@ void QMidiMapper::setWidget(QWidget *widget)
 
 }
 
-void QMidiMapper::onMidiMessageReceive(QMidiMessage *message)
+void QMidiMapper::onMidiEventReceive(QMidiEvent event)
 {
 
 }
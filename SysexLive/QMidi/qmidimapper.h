@@ -3,7 +3,7 @@
 
 #include <QObject>
 #include <QWidget>
-#include "qmidimessage.h"
+#include "qmidievent.h"
 
 class QMidiMapper : public QObject
 {
@@ -19,7 +19,7 @@ signals:
 public slots:
     void setMappingState(bool value = true);
     void setWidget(QWidget *widget);
-    void onMidiMessageReceive(QMidiMessage *message);
+    void onMidiEventReceive(QMidiEvent event);
 };
 
 #endif // QMIDIMAPPER_H
@@ -1,10 +1,24 @@
 #include "qmidiout.h"
-#include <QDebug>
+#include "qmiditrace.h"
+
+RtMidi::Api QMidiOut::_defaultApi = RtMidi::UNSPECIFIED;
+
 QMidiOut::QMidiOut(QObject *parent) : QObject(parent),
-    _midiOut(new RtMidiOut())
+    _midiOut(new RtMidiOut(_defaultApi))
 {
 
 }
+
+//API used by QMidiOut objects created from now on, UNSPECIFIED lets RtMidi choose
+void QMidiOut::setDefaultApi(RtMidi::Api api)
+{
+    _defaultApi = api;
+}
+
+RtMidi::Api QMidiOut::defaultApi()
+{
+    return _defaultApi;
+}
 QStringList QMidiOut::getPorts()
 {
     //TODO: make this static
@@ -15,6 +29,13 @@ QStringList QMidiOut::getPorts()
     }
     return ports;
 }
+//Has the port at this index (still) this name? Port lists get outdated when devices come and go.
+bool QMidiOut::isPortName(unsigned int index, const QString &name)
+{
+    if(index >= _midiOut->getPortCount()) return false;
+    return name == QString::fromStdString(_midiOut->getPortName(index));
+}
+
 void QMidiOut::openPort(unsigned int index)
 {
     _midiOut->openPort(index);
@@ -37,30 +58,82 @@ bool QMidiOut::isPortOpen()
 
 void QMidiOut::sendNoteOn(unsigned int channel, unsigned int pitch, unsigned int velocity)
 {
-    std::vector<unsigned char> message;
-    message.push_back(MIDI_NOTE_ON+channel-1);
-    message.push_back(pitch);
-    message.push_back(velocity);
-    sendRawMessage(message);
+    unsigned char message[3] = { (unsigned char)(MIDI_NOTE_ON+channel-1), (unsigned char)pitch, (unsigned char)velocity };
+    sendRawMessage(message, sizeof(message));
 }
 void QMidiOut::sendNoteOff(unsigned int channel, unsigned int pitch, unsigned int velocity)
 {
-    std::vector<unsigned char> message;
-    message.push_back(MIDI_NOTE_OFF+(channel-1));
-    message.push_back(pitch);
-    message.push_back(velocity);
-    sendRawMessage(message);
+    unsigned char message[3] = { (unsigned char)(MIDI_NOTE_OFF+(channel-1)), (unsigned char)pitch, (unsigned char)velocity };
+    sendRawMessage(message, sizeof(message));
 }
 void QMidiOut::sendMessage(QMidiMessage *message)
 {
-    std::vector<unsigned char> rawMessage = message->getRawMessage();
-    qDebug()<<"send message"<<rawMessage.front();
-    sendRawMessage(rawMessage);
+    //Raw data set by the caller wins, like in QMidiMessage::getRawMessage()
+    if(!message->_rawMessage.empty())
+    {
+        sendRawMessage(&message->_rawMessage[0], message->_rawMessage.size());
+        return;
+    }
+
+    //Channel messages are built on the stack, nothing is allocated
+    unsigned char rawMessage[3];
+    size_t size = 3;
+    switch(message->getStatus())
+    {
+    case MIDI_NOTE_ON:
+    case MIDI_NOTE_OFF:
+        rawMessage[0] = message->getStatus()+message->getChannel()-1;
+        rawMessage[1] = message->getPitch();
+        rawMessage[2] = message->getVelocity();
+        break;
+    case MIDI_CONTROL_CHANGE:
+        rawMessage[0] = MIDI_CONTROL_CHANGE+message->getChannel()-1;
+        rawMessage[1] = message->getControl();
+        rawMessage[2] = message->getValue();
+        break;
+    case MIDI_PROGRAM_CHANGE:
+        rawMessage[0] = MIDI_PROGRAM_CHANGE+message->getChannel()-1;
+        rawMessage[1] = message->getValue();
+        size = 2;
+        break;
+    default:
+        rawMessage[0] = message->getStatus();
+        QMIDI_TRACE_EVENT(QMidiTrace::OutUnsupported, rawMessage, 1);
+        return;
+    }
+    sendRawMessage(rawMessage, size);
 }
 
 void QMidiOut::sendRawMessage(std::vector<unsigned char> &message)
 {
-    _midiOut->sendMessage(&message);
+    if(message.empty()) return;
+    sendRawMessage(&message[0], message.size());
+}
+
+void QMidiOut::sendRawMessage(const unsigned char *message, size_t size)
+{
+    QMIDI_TRACE_EVENT(QMidiTrace::Out, message, size);
+    _midiOut->sendMessage(message, size);
+}
+
+//Several complete messages back to back, handed to the driver at once where possible
+void QMidiOut::sendRawMessages(const unsigned char *messages, size_t size)
+{
+    if(size == 0) return;
+    QMIDI_TRACE_EVENT(QMidiTrace::Out, messages, size);
+    _midiOut->sendMessages(messages, size);
+}
+
+//Wait until everything sent has left the driver buffer, only the ALSA rawmidi API buffers output
+void QMidiOut::drain()
+{
+    _midiOut->drain();
+}
+
+//Lets sendRawMessages() give up while waiting for the device, called from the sending thread
+void QMidiOut::setCancelCallback(RtMidiCancelCallback callback, void *userData)
+{
+    _midiOut->setCancelCallback(callback, userData);
 }
 
 
@@ -11,17 +11,25 @@ class QMidiOut : public QObject
     Q_OBJECT
 public:
     explicit QMidiOut(QObject *parent = 0);
+    static void setDefaultApi(RtMidi::Api api);
+    static RtMidi::Api defaultApi();
     void noteOn(unsigned int note, unsigned int value);
     QStringList getPorts();
+    bool isPortName(unsigned int index, const QString &name);
     void sendNoteOn(unsigned int channel, unsigned int pitch, unsigned int velocity);
     void sendNoteOff(unsigned int channel, unsigned int pitch, unsigned int velocity);
     void sendMessage(QMidiMessage *message);
     void sendRawMessage(std::vector<unsigned char> &message);
+    void sendRawMessage(const unsigned char *message, size_t size);
+    void sendRawMessages(const unsigned char *messages, size_t size);
+    void drain();
+    void setCancelCallback(RtMidiCancelCallback callback, void *userData);
     void openPort(unsigned int index);
     void openVirtualPort(QString name);
     void closePort(void);
     bool isPortOpen();
 private:
+    static RtMidi::Api _defaultApi;
     RtMidiOut *_midiOut;
 
 
@@ -65,22 +65,22 @@ bool QMidiPianoRoll::isSemiTone(int pitch)
 ////    QPainter painter(this);
 //}
 
-void QMidiPianoRoll::onMidiReceive(QMidiMessage *message)
+void QMidiPianoRoll::onMidiReceive(QMidiEvent event)
 {
-    switch(message->getStatus())
+    switch(event.getStatus())
     {
     case MIDI_NOTE_ON: {
         QBrush brush;
         brush.setStyle(Qt::SolidPattern);
-        brush.setColor(QColor(0,0,200, message->getVelocity()*2));
-        _keys[message->getPitch()]->setBrush(brush);
+        brush.setColor(QColor(0,0,200, event.getVelocity()*2));
+        _keys[event.getPitch()]->setBrush(brush);
         break;
     }
     case MIDI_NOTE_OFF: {
         QBrush brush;
         brush.setStyle(Qt::SolidPattern);
         QColor color;
-        if(isSemiTone(message->getPitch()))
+        if(isSemiTone(event.getPitch()))
         {
             color = QColor(Qt::black);
         }
@@ -89,7 +89,7 @@ void QMidiPianoRoll::onMidiReceive(QMidiMessage *message)
              color = QColor(Qt::white);
         }
         brush.setColor(color);
-        _keys[message->getPitch()]->setBrush(brush);
+        _keys[event.getPitch()]->setBrush(brush);
         break;
     }
     default: break;
@@ -5,7 +5,7 @@
 #include <QGraphicsView>
 #include <QGraphicsScene>
 
-#include "qmidimessage.h"
+#include "qmidievent.h"
 class QMidiPianoRoll :
         public QGraphicsView
 {
@@ -24,7 +24,7 @@ private:
 signals:
 
 public slots:
-    void onMidiReceive(QMidiMessage *message);
+    void onMidiReceive(QMidiEvent event);
 };
 
 #endif // QMIDIPIANOROLL_H
@@ -0,0 +1,106 @@
+#include "qmidiportregistry.h"
+#include "qmidiin.h"
+#include "qmidiout.h"
+
+QMidiPortRegistry::QMidiPortRegistry(QObject *parent) : QObject(parent),
+    _midiIn(new RtMidiIn(QMidiIn::defaultApi(), "QMidi Port Registry")),
+    _midiOut(new RtMidiOut(QMidiOut::defaultApi(), "QMidi Port Registry"))
+{
+    _refreshTimer = new QTimer(this);
+    connect(_refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+    //Announced changes are collected for a moment, without announcements the ports are polled
+    _watcher = new RtMidiPortWatcher(&QMidiPortRegistry::portCallback, this);
+    if(_watcher->isWatching())
+    {
+        _refreshTimer->setSingleShot(true);
+        _refreshTimer->setInterval(QMIDI_PORT_SETTLE_MS);
+    }
+    else
+    {
+        _refreshTimer->start(QMIDI_PORT_POLL_MS);
+    }
+
+    refresh();
+}
+
+QMidiPortRegistry::~QMidiPortRegistry()
+{
+    //Stops the watcher thread, no more callbacks after this
+    delete _watcher;
+    delete _midiIn;
+    delete _midiOut;
+}
+
+QStringList QMidiPortRegistry::inputPorts() const
+{
+    return _inputPorts;
+}
+
+QStringList QMidiPortRegistry::outputPorts() const
+{
+    return _outputPorts;
+}
+
+//Index for QMidiIn::openPort(), -1 if there is no such port
+int QMidiPortRegistry::inputIndex(const QString &name) const
+{
+    return _inputIndex.value(name, -1);
+}
+
+//Index for QMidiOut::openPort(), -1 if there is no such port
+int QMidiPortRegistry::outputIndex(const QString &name) const
+{
+    return _outputIndex.value(name, -1);
+}
+
+//Are changes announced by the system? Else they are found by polling.
+bool QMidiPortRegistry::isWatching() const
+{
+    return _watcher->isWatching();
+}
+
+//Enumerate all ports now, emits portsChanged() if they differ
+void QMidiPortRegistry::refresh()
+{
+    QStringList inputPorts;
+    for(unsigned int i = 0; i < _midiIn->getPortCount(); i++)
+    {
+        inputPorts.append(QString::fromStdString(_midiIn->getPortName(i)));
+    }
+    QStringList outputPorts;
+    for(unsigned int i = 0; i < _midiOut->getPortCount(); i++)
+    {
+        outputPorts.append(QString::fromStdString(_midiOut->getPortName(i)));
+    }
+    if(inputPorts == _inputPorts && outputPorts == _outputPorts) return;
+
+    _inputPorts = inputPorts;
+    _outputPorts = outputPorts;
+    _inputIndex = indexPorts(_inputPorts);
+    _outputIndex = indexPorts(_outputPorts);
+    emit portsChanged();
+}
+
+//Restart the settle time with every announcement
+void QMidiPortRegistry::scheduleRefresh()
+{
+    _refreshTimer->start();
+}
+
+//Called on the watcher thread
+void QMidiPortRegistry::portCallback(void *userData)
+{
+    QMetaObject::invokeMethod(static_cast<QMidiPortRegistry*>(userData), "scheduleRefresh", Qt::QueuedConnection);
+}
+
+//Name to index, the first port wins if names are not unique
+QHash<QString, int> QMidiPortRegistry::indexPorts(const QStringList &ports)
+{
+    QHash<QString, int> index;
+    for(int i = ports.size() - 1; i >= 0; i--)
+    {
+        index.insert(ports.at(i), i);
+    }
+    return index;
+}
@@ -0,0 +1,53 @@
+#ifndef QMIDIPORTREGISTRY_H
+#define QMIDIPORTREGISTRY_H
+
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QTimer>
+#include "RtMidi.h"
+
+//Wait this long after the last announcement before enumerating, devices announce several ports
+#define QMIDI_PORT_SETTLE_MS 100
+//Polling interval if the API does not announce port changes
+#define QMIDI_PORT_POLL_MS 2000
+
+//Cached MIDI port lists, enumerated once and again only when ports appear or disappear.
+//Lookups by name go through a hash. Lives in the GUI thread.
+class QMidiPortRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QMidiPortRegistry(QObject *parent = 0);
+    ~QMidiPortRegistry();
+    QStringList inputPorts() const;
+    QStringList outputPorts() const;
+    int inputIndex(const QString &name) const;
+    int outputIndex(const QString &name) const;
+    bool isWatching() const;
+
+signals:
+    //Port lists differ from the last enumeration
+    void portsChanged();
+
+public slots:
+    void refresh();
+
+private slots:
+    void scheduleRefresh();
+
+private:
+    static void portCallback(void *userData);
+    static QHash<QString, int> indexPorts(const QStringList &ports);
+
+    RtMidiIn *_midiIn;
+    RtMidiOut *_midiOut;
+    RtMidiPortWatcher *_watcher;
+    QTimer *_refreshTimer;
+    QStringList _inputPorts;
+    QStringList _outputPorts;
+    QHash<QString, int> _inputIndex;
+    QHash<QString, int> _outputIndex;
+};
+
+#endif // QMIDIPORTREGISTRY_H
@@ -0,0 +1,136 @@
+#include "qmiditrace.h"
+#include "qmidievent.h"
+#include <QFile>
+#include <QDataStream>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+//File layout: magic, version, record size, record count, then the raw records in host byte order
+static const char traceMagic[4] = { 'Q', 'M', 'T', 'R' };
+static const quint32 traceVersion = 1;
+
+//Ring slot. The sequence is published after the record, so a reader can tell a record which changed while it copied it.
+struct QMidiTraceSlot
+{
+    QAtomicInt sequence;    //0 = empty or being written
+    QMidiTraceRecord record;
+};
+
+static QMidiTraceSlot traceSlots[QMIDI_TRACE_SIZE];
+static QAtomicInt traceNext(0);
+
+static bool sequenceLessThan(const QMidiTraceRecord &a, const QMidiTraceRecord &b)
+{
+    return a.sequence < b.sequence;
+}
+
+bool QMidiTrace::isEnabled()
+{
+#ifdef QMIDI_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+//Called on the MIDI threads: no locks, no allocation, no formatting
+void QMidiTrace::record(Type type, const unsigned char *data, size_t size)
+{
+    quint32 sequence = (quint32)traceNext.fetchAndAddRelaxed(1) + 1;
+    QMidiTraceSlot &slot = traceSlots[(sequence - 1) & (QMIDI_TRACE_SIZE - 1)];
+    QMidiTraceRecord &record = slot.record;
+
+    //Marked as being written before the record changes, a dump taken meanwhile skips it
+    slot.sequence.fetchAndStoreAcquire(0);
+    record.sequence = sequence;
+    record.timestamp = QMidiEvent::currentTimestamp();
+    record.type = (quint16)type;
+    record.reserved = 0;
+    record.size = (quint32)size;
+    record.reserved2 = 0;
+    size_t bytes = size < QMIDI_TRACE_BYTES ? size : QMIDI_TRACE_BYTES;
+    if(bytes > 0) memcpy(record.bytes, data, bytes);
+    if(bytes < QMIDI_TRACE_BYTES) memset(record.bytes + bytes, 0, QMIDI_TRACE_BYTES - bytes);
+    slot.sequence.storeRelease((int)sequence);
+}
+
+//Write the current ring content, oldest record first
+bool QMidiTrace::dump(const QString &fileName)
+{
+    std::vector<QMidiTraceRecord> records;
+    records.reserve(QMIDI_TRACE_SIZE);
+    for(int i = 0; i < QMIDI_TRACE_SIZE; i++)
+    {
+        //Seqlock read: keep the copy only if the slot was complete and unchanged all the time
+        int before = traceSlots[i].sequence.loadAcquire();
+        if(before == 0) continue;
+        QMidiTraceRecord record = traceSlots[i].record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(traceSlots[i].sequence.loadAcquire() != before) continue;
+        records.push_back(record);
+    }
+    std::sort(records.begin(), records.end(), sequenceLessThan);
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QDataStream stream(&file);
+    stream.writeRawData(traceMagic, sizeof(traceMagic));
+    stream << traceVersion << (quint32)sizeof(QMidiTraceRecord) << (quint32)records.size();
+    if(!records.empty()) stream.writeRawData((const char*)&records[0], (int)(records.size() * sizeof(QMidiTraceRecord)));
+    return stream.status() == QDataStream::Ok;
+}
+
+//Read a dump file and decode it into text lines
+bool QMidiTrace::load(const QString &fileName, QStringList &lines)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream stream(&file);
+
+    char magic[4];
+    quint32 version, recordSize, count;
+    if(stream.readRawData(magic, sizeof(magic)) != sizeof(magic)) return false;
+    if(memcmp(magic, traceMagic, sizeof(magic)) != 0) return false;
+    stream >> version >> recordSize >> count;
+    if(version != traceVersion || recordSize != sizeof(QMidiTraceRecord)) return false;
+
+    qint64 startTime = 0;
+    for(quint32 i = 0; i < count; i++)
+    {
+        QMidiTraceRecord record;
+        if(stream.readRawData((char*)&record, sizeof(record)) != sizeof(record)) return false;
+        if(i == 0) startTime = record.timestamp;
+        lines.append(decode(record, startTime));
+    }
+    return true;
+}
+
+//One record as text: time since start in ms, type, bytes in hex
+QString QMidiTrace::decode(const QMidiTraceRecord &record, qint64 startTime)
+{
+    QString line = QString("%1 %2 %3")
+            .arg((record.timestamp - startTime) / 1000000.0, 12, 'f', 3)
+            .arg(record.sequence, 8)
+            .arg(typeName(record.type), -16);
+    quint32 bytes = record.size < QMIDI_TRACE_BYTES ? record.size : QMIDI_TRACE_BYTES;
+    for(quint32 i = 0; i < bytes; i++)
+    {
+        line.append(QString(" %1").arg((uint)record.bytes[i], 2, 16, QChar('0')).toUpper());
+    }
+    if(record.size > bytes) line.append(QString(" ... (%1 bytes)").arg(record.size));
+    return line;
+}
+
+QString QMidiTrace::typeName(int type)
+{
+    switch(type)
+    {
+    case In: return "IN";
+    case InOverrun: return "IN OVERRUN";
+    case InSysexDropped: return "IN SYSEX DROPPED";
+    case Out: return "OUT";
+    case OutUnsupported: return "OUT UNSUPPORTED";
+    default: return QString("TYPE %1").arg(type);
+    }
+}
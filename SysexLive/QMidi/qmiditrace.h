@@ -0,0 +1,53 @@
+#ifndef QMIDITRACE_H
+#define QMIDITRACE_H
+
+#include <QString>
+#include <QStringList>
+#include <QAtomicInt>
+
+//Tracing is compiled in with "CONFIG += qmidi_trace" (defines QMIDI_TRACE), else it costs nothing
+#ifdef QMIDI_TRACE
+#define QMIDI_TRACE_EVENT(type, data, size) QMidiTrace::record(type, data, size)
+#else
+#define QMIDI_TRACE_EVENT(type, data, size) do {} while(0)
+#endif
+
+//Number of records kept, must be a power of two. The oldest ones are overwritten.
+#define QMIDI_TRACE_SIZE 4096
+//Message bytes stored per record, longer messages (sysex) keep their head only
+#define QMIDI_TRACE_BYTES 16
+
+//One binary trace record, 40 bytes, written as is into dump files
+struct QMidiTraceRecord
+{
+    qint64 timestamp;       //ns, QMidiEvent::currentTimestamp()
+    quint32 sequence;       //Order of recording, starts at 1
+    quint16 type;           //QMidiTrace::Type
+    quint16 reserved;
+    quint32 size;           //Full message size
+    quint32 reserved2;
+    unsigned char bytes[QMIDI_TRACE_BYTES];
+};
+
+//Preallocated, lock-free trace ring for the real-time MIDI threads. Formatting happens offline.
+class QMidiTrace
+{
+public:
+    enum Type
+    {
+        In = 1,             //Message received by QMidiIn
+        InOverrun = 2,      //Message lost, input queue was full
+        InSysexDropped = 3, //Sysex lost, all sysex buffers were in use
+        Out = 4,            //Message sent by QMidiOut
+        OutUnsupported = 5  //QMidiMessage with a status QMidiOut can not build
+    };
+
+    static bool isEnabled();
+    static void record(Type type, const unsigned char *data, size_t size);
+    static bool dump(const QString &fileName);
+    static bool load(const QString &fileName, QStringList &lines);
+    static QString decode(const QMidiTraceRecord &record, qint64 startTime);
+    static QString typeName(int type);
+};
+
+#endif // QMIDITRACE_H
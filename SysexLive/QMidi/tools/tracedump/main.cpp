@@ -0,0 +1,30 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include "qmiditrace.h"
+
+//Usage: tracedump <file.qmtr>
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList arguments = a.arguments();
+    if(arguments.size() != 2)
+    {
+        err << "Usage: tracedump <file.qmtr>" << endl;
+        return 1;
+    }
+
+    QStringList lines;
+    if(!QMidiTrace::load(arguments.at(1), lines))
+    {
+        err << "Could not read trace file " << arguments.at(1) << endl;
+        return 1;
+    }
+
+    out << QString("%1 %2 %3").arg("time (ms)", 12).arg("seq", 8).arg("type", -16) << " bytes" << endl;
+    for(int i = 0; i < lines.size(); i++) out << lines.at(i) << endl;
+    return 0;
+}
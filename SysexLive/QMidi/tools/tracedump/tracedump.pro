@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Decodes binary MIDI trace dumps (QMidiTrace::dump) into text
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = tracedump
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += main.cpp \
+    $$PWD/../../qmiditrace.cpp
+
+HEADERS += \
+    $$PWD/../../qmiditrace.h \
+    $$PWD/../../qmidievent.h \
+    $$PWD/../../qmidimessage.h
@@ -0,0 +1,69 @@
+/*!
+ * \file RealtimeDialog.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the real-time scheduling and memory locking of the MIDI threads
+ */
+
+#include "RealtimeDialog.h"
+#include <QGridLayout>
+#include <QLabel>
+#include <QDialogButtonBox>
+#include <QThread>
+
+//Constructor
+RealtimeDialog::RealtimeDialog( QWidget *parent )
+    : QDialog( parent )
+{
+    setWindowTitle( tr( "Real-Time Priority" ) );
+
+    //The lowest value of each box means "off"
+    m_priority = new QSpinBox( this );
+    m_priority->setRange( 0, 99 );
+    m_priority->setSpecialValueText( tr( "Off" ) );
+    m_cpu = new QSpinBox( this );
+    m_cpu->setRange( -1, QThread::idealThreadCount() - 1 );
+    m_cpu->setSpecialValueText( tr( "Any" ) );
+    m_lockPatches = new QCheckBox( tr( "Keep patches in RAM" ), this );
+
+    QGridLayout *layout = new QGridLayout( this );
+    layout->addWidget( new QLabel( tr( "SCHED_FIFO priority of MIDI input (1-99), sending runs one below" ) ), 0, 0 );
+    layout->addWidget( m_priority, 0, 1 );
+    layout->addWidget( new QLabel( tr( "MIDI input on CPU" ) ), 1, 0 );
+    layout->addWidget( m_cpu, 1, 1 );
+    layout->addWidget( m_lockPatches, 2, 0, 1, 2 );
+    QLabel *hint = new QLabel( tr( "Needs rtprio and memlock limits for your user (/etc/security/limits.conf), else SysexLive runs without. Takes effect when listening starts." ) );
+    hint->setWordWrap( true );
+    layout->addWidget( hint, 3, 0, 1, 2 );
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, this );
+    connect( buttonBox, SIGNAL(accepted()), this, SLOT(accept()) );
+    connect( buttonBox, SIGNAL(rejected()), this, SLOT(reject()) );
+    layout->addWidget( buttonBox, 4, 0, 1, 2 );
+}
+
+//Preset the values
+void RealtimeDialog::setSettings( int priority, int cpu, bool lockPatches )
+{
+    m_priority->setValue( priority );
+    m_cpu->setValue( cpu );
+    m_lockPatches->setChecked( lockPatches );
+}
+
+//SCHED_FIFO priority, 0 = normal scheduling
+int RealtimeDialog::priority( void ) const
+{
+    return m_priority->value();
+}
+
+//CPU for the MIDI input thread, -1 = any
+int RealtimeDialog::cpu( void ) const
+{
+    return m_cpu->value();
+}
+
+//Lock the patch cache into RAM?
+bool RealtimeDialog::lockPatches( void ) const
+{
+    return m_lockPatches->isChecked();
+}
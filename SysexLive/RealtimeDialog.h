@@ -0,0 +1,31 @@
+/*!
+ * \file RealtimeDialog.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Dialog for the real-time scheduling and memory locking of the MIDI threads
+ */
+
+#ifndef REALTIMEDIALOG_H
+#define REALTIMEDIALOG_H
+
+#include <QDialog>
+#include <QSpinBox>
+#include <QCheckBox>
+
+class RealtimeDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit RealtimeDialog( QWidget *parent = 0 );
+    void setSettings( int priority, int cpu, bool lockPatches );
+    int priority( void ) const;
+    int cpu( void ) const;
+    bool lockPatches( void ) const;
+
+private:
+    QSpinBox *m_priority;
+    QSpinBox *m_cpu;
+    QCheckBox *m_lockPatches;
+};
+
+#endif // REALTIMEDIALOG_H
@@ -0,0 +1,223 @@
+/*!
+ * \file SendEngine.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Sends patches to all synths in parallel, one thread per port
+ */
+
+#include "SendEngine.h"
+#include <QMetaType>
+
+//Constructor
+SendEngine::SendEngine( QObject *parent )
+    : QObject( parent )
+    , m_activeJob( 0 )
+    , m_jobId( 0 )
+    , m_pending( 0 )
+    , m_cancelled( false )
+    , m_bytesTotal( 0 )
+    , m_jobTimestamp( 0 )
+    , m_jobFinishedAt( 0 )
+{
+    qRegisterMetaType<SysexPatchPtr>( "SysexPatchPtr" );
+
+    //Every port gets its own thread, so a long dump for one synth does not delay the others
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        m_bytesSent[i] = 0;
+        m_threads[i] = new QThread( this );
+        m_ports[i] = new SynthPort( i, &m_activeJob, &m_latencyStats );
+        m_ports[i]->moveToThread( m_threads[i] );
+        connect( m_ports[i], SIGNAL(progress(int,int,int)), this, SLOT(onPortProgress(int,int,int)) );
+        connect( m_ports[i], SIGNAL(sent(int,int,bool,qint64)), this, SLOT(onPortSent(int,int,bool,qint64)) );
+        connect( m_ports[i], SIGNAL(portError(int,const QString &)), this, SIGNAL(portError(int,const QString &)) );
+        m_threads[i]->start();
+    }
+}
+
+//Destructor
+SendEngine::~SendEngine()
+{
+    cancel();
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        QMetaObject::invokeMethod( m_ports[i], "close", Qt::BlockingQueuedConnection );
+        m_threads[i]->quit();
+        m_threads[i]->wait();
+        delete m_ports[i];
+    }
+}
+
+//Connect slot to the port with this name
+void SendEngine::setPortName( int slot, const QString &portName )
+{
+    if( slot < 0 || slot >= SYNTH_SLOTS ) return;
+    QMetaObject::invokeMethod( m_ports[slot], "setPortName", Qt::QueuedConnection,
+                               Q_ARG( QString, portName ), Q_ARG( QStringList, m_portList ) );
+}
+
+//Disconnect slot
+void SendEngine::closePort( int slot )
+{
+    if( slot < 0 || slot >= SYNTH_SLOTS ) return;
+    QMetaObject::invokeMethod( m_ports[slot], "close", Qt::QueuedConnection );
+}
+
+//Port list has changed, let all slots follow their ports
+void SendEngine::reconnect( const QStringList &ports )
+{
+    m_portList = ports;
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        QMetaObject::invokeMethod( m_ports[i], "reconnect", Qt::QueuedConnection, Q_ARG( QStringList, ports ) );
+    }
+}
+
+//Pacing for a slot: gap after each message and data rate ceiling
+void SendEngine::setPacing( int slot, int delayMs, int bytesPerSecond )
+{
+    if( slot < 0 || slot >= SYNTH_SLOTS ) return;
+    QMetaObject::invokeMethod( m_ports[slot], "setPacing", Qt::QueuedConnection,
+                               Q_ARG( int, delayMs ), Q_ARG( int, bytesPerSecond ) );
+}
+
+//Delta mode for all slots: only changed messages are sent
+void SendEngine::setDeltaMode( bool enabled )
+{
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        QMetaObject::invokeMethod( m_ports[i], "setDeltaMode", Qt::QueuedConnection, Q_ARG( bool, enabled ) );
+    }
+}
+
+//A patch file changed: delta mode must not compare against what was sent before
+void SendEngine::forgetSentPatches( void )
+{
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        QMetaObject::invokeMethod( m_ports[i], "forgetLastPatch", Qt::QueuedConnection );
+    }
+}
+
+//SCHED_FIFO priority of all port threads, 0 = normal scheduling
+void SendEngine::setRealtime( int priority )
+{
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        QMetaObject::invokeMethod( m_ports[i], "setRealtime", Qt::QueuedConnection, Q_ARG( int, priority ) );
+    }
+}
+
+//Queue a job, a running job is cancelled at the next message boundary. Returns immediately.
+//Thread safe, the MIDI input thread may call it directly.
+int SendEngine::submit( const SendJob &job )
+{
+    //Id and publication in one step: with submit() and cancel() racing on several threads, the newest id always wins
+    int jobId = m_activeJob.fetchAndAddOrdered( 1 ) + 1;
+    qint64 submitted = LatencyStats::now();
+
+    int bytesTotal = 0;
+    int pending = 0;
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        if( job.patches[i].isNull() ) continue;
+        bytesTotal += (int)job.patches[i]->size;
+        pending++;
+    }
+
+    //Bookkeeping runs in the engine thread, queued before the ports are started so it is done before they report back
+    if( QThread::currentThread() == thread() )
+    {
+        onJobAccepted( jobId, job.row, job.timestamp, bytesTotal, pending );
+    }
+    else
+    {
+        QMetaObject::invokeMethod( this, "onJobAccepted", Qt::QueuedConnection,
+                                   Q_ARG( int, jobId ), Q_ARG( int, job.row ), Q_ARG( qint64, job.timestamp ),
+                                   Q_ARG( int, bytesTotal ), Q_ARG( int, pending ) );
+    }
+
+    for( int i = 0; i < SYNTH_SLOTS; i++ )
+    {
+        if( job.patches[i].isNull() ) continue;
+        QMetaObject::invokeMethod( m_ports[i], "send", Qt::QueuedConnection,
+                                   Q_ARG( int, jobId ), Q_ARG( SysexPatchPtr, job.patches[i] ),
+                                   Q_ARG( qint64, submitted ) );
+    }
+    return jobId;
+}
+
+//Stop the running job at the next message boundary
+void SendEngine::cancel( void )
+{
+    if( m_pending > 0 ) emit jobFinished( m_jobId, true );
+    m_pending = 0;
+    m_activeJob.fetchAndAddOrdered( 1 );
+}
+
+//Still sending?
+bool SendEngine::isBusy( void ) const
+{
+    return m_pending > 0;
+}
+
+//A job was submitted, the previous one is replaced
+void SendEngine::onJobAccepted( int jobId, int row, qint64 timestamp, int bytesTotal, int pending )
+{
+    //A job submitted later from another thread was already accepted
+    if( jobId < m_jobId ) return;
+    if( m_pending > 0 ) emit jobFinished( m_jobId, true );
+
+    m_jobId = jobId;
+    m_pending = pending;
+    m_cancelled = false;
+    m_bytesTotal = bytesTotal;
+    m_jobTimestamp = timestamp;
+    m_jobFinishedAt = 0;
+    for( int i = 0; i < SYNTH_SLOTS; i++ ) m_bytesSent[i] = 0;
+
+    emit jobStarted( jobId, row );
+
+    //Cancelled before the bookkeeping got here, the ports drop it on their own
+    if( jobId != m_activeJob.load() )
+    {
+        m_pending = 0;
+        emit jobFinished( jobId, true );
+    }
+    else if( pending == 0 ) emit jobFinished( jobId, false );
+}
+
+//Latency measurements of the whole way from program change to synth
+LatencyStats *SendEngine::latencyStats( void )
+{
+    return &m_latencyStats;
+}
+
+//A port thread has sent a message
+void SendEngine::onPortProgress( int jobId, int slot, int bytesSent )
+{
+    if( jobId != m_jobId || jobId != m_activeJob.load() || m_bytesTotal == 0 ) return;
+    m_bytesSent[slot] = bytesSent;
+
+    int bytesSentTotal = 0;
+    for( int i = 0; i < SYNTH_SLOTS; i++ ) bytesSentTotal += m_bytesSent[i];
+    emit jobProgress( jobId, (int)( (qint64)bytesSentTotal * 100 / m_bytesTotal ) );
+}
+
+//A port thread has finished or aborted its patch
+void SendEngine::onPortSent( int jobId, int slot, bool cancelled, qint64 finishedAt )
+{
+    //Results of replaced jobs are not interesting anymore
+    if( jobId != m_jobId || jobId != m_activeJob.load() || m_pending == 0 ) return;
+
+    if( cancelled ) m_cancelled = true;
+    else emit portFinished( slot );
+    m_jobFinishedAt = qMax( m_jobFinishedAt, finishedAt );
+    m_pending--;
+    if( m_pending == 0 )
+    {
+        //Time until the last byte left the slowest port, not until this slot was called
+        if( !m_cancelled && m_jobTimestamp > 0 ) m_latencyStats.record( LatencyTotal, m_jobFinishedAt - m_jobTimestamp );
+        emit jobFinished( jobId, m_cancelled );
+    }
+}
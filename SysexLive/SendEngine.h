@@ -0,0 +1,80 @@
+/*!
+ * \file SendEngine.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Sends patches to all synths in parallel, one thread per port
+ */
+
+#ifndef SENDENGINE_H
+#define SENDENGINE_H
+
+#include <QObject>
+#include <QThread>
+#include <QStringList>
+#include <QAtomicInt>
+#include "SynthPort.h"
+#include "PatchCache.h"
+#include "LatencyStats.h"
+
+#define SYNTH_SLOTS 4
+
+//All patches of one setlist entry
+struct SendJob
+{
+    int row;
+    SysexPatchPtr patches[SYNTH_SLOTS];
+    qint64 timestamp;   //When the job was requested, LatencyStats::now()
+
+    SendJob() : row( -1 ), timestamp( 0 ) {}
+};
+
+class SendEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SendEngine( QObject *parent = 0 );
+    ~SendEngine();
+    void setPortName( int slot, const QString &portName );
+    void closePort( int slot );
+    void reconnect( const QStringList &ports );
+    void setPacing( int slot, int delayMs, int bytesPerSecond );
+    void setDeltaMode( bool enabled );
+    void setRealtime( int priority );
+    int submit( const SendJob &job );
+    bool isBusy( void ) const;
+    LatencyStats *latencyStats( void );
+
+public slots:
+    void cancel( void );
+    void forgetSentPatches( void );
+
+signals:
+    void jobStarted( int jobId, int row );
+    void jobProgress( int jobId, int percent );
+    void jobFinished( int jobId, bool cancelled );
+    void portFinished( int slot );
+    void portError( int slot, const QString &message );
+
+private slots:
+    void onJobAccepted( int jobId, int row, qint64 timestamp, int bytesTotal, int pending );
+    void onPortProgress( int jobId, int slot, int bytesSent );
+    void onPortSent( int jobId, int slot, bool cancelled, qint64 finishedAt );
+
+private:
+    SynthPort *m_ports[SYNTH_SLOTS];
+    QThread *m_threads[SYNTH_SLOTS];
+    //Output ports as last enumerated by the GUI, slots never enumerate themselves
+    QStringList m_portList;
+    //Id of the newest job, also the id counter. Any other id is cancelled.
+    QAtomicInt m_activeJob;
+    int m_jobId;
+    int m_pending;
+    bool m_cancelled;
+    int m_bytesTotal;
+    int m_bytesSent[SYNTH_SLOTS];
+    qint64 m_jobTimestamp;
+    qint64 m_jobFinishedAt;
+    LatencyStats m_latencyStats;
+};
+
+#endif // SENDENGINE_H
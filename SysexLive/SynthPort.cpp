@@ -0,0 +1,294 @@
+/*!
+ * \file SynthPort.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief A long-living MIDI output connection for one synth slot
+ */
+
+#include "SynthPort.h"
+#include <QThread>
+#include <cstring>
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//Constructor
+SynthPort::SynthPort( int slot, const QAtomicInt *activeJob, LatencyStats *latencyStats, QObject *parent )
+    : QObject( parent )
+    , m_slot( slot )
+    , m_jobId( 0 )
+    , m_portIndex( -1 )
+    , m_activeJob( activeJob )
+    , m_latencyStats( latencyStats )
+    , m_delayMs( 0 )
+    , m_bytesPerSecond( 0 )
+    , m_deltaMode( false )
+{
+    m_midiOut = new QMidiOut( this );
+    m_midiOut->setCancelCallback( &SynthPort::isSendCancelled, this );
+}
+
+//Destructor
+SynthPort::~SynthPort()
+{
+    close();
+}
+
+//Synth slot (0..3) this port belongs to
+int SynthPort::slot( void ) const
+{
+    return m_slot;
+}
+
+//Name of the connected (or wanted) port
+QString SynthPort::portName( void ) const
+{
+    return m_portName;
+}
+
+//Connect to another port out of the current port list, keeps the connection open until changed
+void SynthPort::setPortName( const QString &portName, const QStringList &ports )
+{
+    if( portName == m_portName && isOpen() ) return;
+    close();
+    m_portName = portName;
+    reconnect( ports );
+}
+
+//Follow the port after devices were plugged or unplugged
+void SynthPort::reconnect( const QStringList &ports )
+{
+    int index = ports.indexOf( m_portName );
+
+    //Still connected to the right port? Nothing to do.
+    if( index == m_portIndex && isOpen() ) return;
+
+    close();
+    //The list may be outdated by now: check the name right before opening, else ask the driver
+    if( index >= 0 && !m_midiOut->isPortName( index, m_portName ) ) index = m_midiOut->getPorts().indexOf( m_portName );
+    if( index >= 0 ) open( index );
+}
+
+//Close the connection, but remember the wanted port
+void SynthPort::close( void )
+{
+    if( m_midiOut->isPortOpen() ) m_midiOut->closePort();
+    m_portIndex = -1;
+    //A reconnected synth may have been switched off
+    m_lastSentPatch.clear();
+}
+
+//Is there a connection?
+bool SynthPort::isOpen( void )
+{
+    return m_midiOut->isPortOpen();
+}
+
+//Send patch data message by message, port has to be opened before
+void SynthPort::send( int jobId, SysexPatchPtr patch, qint64 submitted )
+{
+    //A newer job may have been started while this one was waiting
+    if( isCancelled( jobId ) )
+    {
+        emit sent( jobId, m_slot, true, LatencyStats::now() );
+        return;
+    }
+    m_latencyStats->recordSince( LatencyQueue, submitted );
+    m_jobId = jobId;
+
+    if( isOpen() && !patch.isNull() )
+    {
+        const unsigned char *data = patch->data;
+        const std::vector<SysexMessage> &messages = patch->messages;
+        bool delta = m_deltaMode && isDeltaPossible( patch );
+
+        //Until this job is complete, the synth state is unknown
+        SysexPatchPtr lastSentPatch = m_lastSentPatch;
+        m_lastSentPatch.clear();
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 lastSent = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesDone = 0;
+        bool firstMessage = true;
+
+        //Without pacing, adjacent messages are handed to the driver in batches of about SYNTHPORT_BATCH_BYTES
+        bool batch = m_delayMs == 0 && m_bytesPerSecond == 0;
+        size_t batchStart = 0;
+        size_t batchEnd = 0;
+        qint64 batchDone = 0;
+        for( size_t i = 0; i < messages.size(); i++ )
+        {
+            bytesDone += messages[i].length;
+
+            //Delta mode: skip messages the synth already got with the last patch
+            if( delta && memcmp( &data[messages[i].offset],
+                                 &lastSentPatch->data[lastSentPatch->messages[i].offset],
+                                 messages[i].length ) == 0 )
+            {
+                continue;
+            }
+
+            if( batch )
+            {
+                //Not adjacent to the pending messages (skipped message or gap) or batch full: send those first.
+                //Batches hold complete messages, so a newer job aborts between them.
+                if( batchEnd > batchStart
+                 && ( messages[i].offset != batchEnd || batchEnd - batchStart + messages[i].length > SYNTHPORT_BATCH_BYTES ) )
+                {
+                    if( !flushBatch( jobId, data, batchStart, batchEnd - batchStart, batchDone ) )
+                    {
+                        emit sent( jobId, m_slot, true, LatencyStats::now() );
+                        return;
+                    }
+                    batchEnd = batchStart;
+                }
+                if( batchEnd == batchStart ) batchStart = messages[i].offset;
+                batchEnd = messages[i].offset + messages[i].length;
+                batchDone = bytesDone;
+                continue;
+            }
+
+            //Give the synth time to digest the previous message, abort only between complete messages
+            if( !firstMessage && !waitForNextMessage( jobId, timer, lastSent, bytesSent ) )
+            {
+                emit sent( jobId, m_slot, true, LatencyStats::now() );
+                return;
+            }
+            firstMessage = false;
+
+            qint64 sendStart = LatencyStats::now();
+            m_midiOut->sendRawMessage( data + messages[i].offset, messages[i].length );
+            //The pause before the next message starts when this one is on the wire, not in the driver buffer
+            m_midiOut->drain();
+            m_latencyStats->recordSince( LatencyEncodeDrain, sendStart );
+            lastSent = timer.nsecsElapsed();
+            bytesSent += messages[i].length;
+            emit progress( jobId, m_slot, (int)bytesDone );
+        }
+        if( batch ) sendBatch( data, batchStart, batchEnd - batchStart );
+        emit progress( jobId, m_slot, (int)bytesDone );
+        m_lastSentPatch = patch;
+    }
+    emit sent( jobId, m_slot, false, LatencyStats::now() );
+}
+
+//Send a batch and report progress, returns false if the job was cancelled meanwhile
+bool SynthPort::flushBatch( int jobId, const unsigned char *data, size_t offset, size_t length, qint64 bytesDone )
+{
+    sendBatch( data, offset, length );
+    emit progress( jobId, m_slot, (int)bytesDone );
+    return !isCancelled( jobId );
+}
+
+//Hand several adjacent messages to the driver at once
+void SynthPort::sendBatch( const unsigned char *data, size_t offset, size_t length )
+{
+    if( length == 0 ) return;
+    qint64 sendStart = LatencyStats::now();
+    m_midiOut->sendRawMessages( data + offset, length );
+    //Progress, cancel checks and the job end refer to bytes on the wire
+    m_midiOut->drain();
+    m_latencyStats->recordSince( LatencyEncodeDrain, sendStart );
+}
+
+//Send only messages which differ from the last patch sent to this port
+void SynthPort::setDeltaMode( bool enabled )
+{
+    m_deltaMode = enabled;
+    m_lastSentPatch.clear();
+}
+
+//The synth state is unknown, the next patch is sent completely
+void SynthPort::forgetLastPatch( void )
+{
+    m_lastSentPatch.clear();
+}
+
+//Scheduling of the thread this port lives in: SCHED_FIFO for priority > 0, else normal
+void SynthPort::setRealtime( int priority )
+{
+#ifdef Q_OS_LINUX
+    struct sched_param param;
+    param.sched_priority = 0;
+    if( priority > 0 )
+    {
+        param.sched_priority = qBound( sched_get_priority_min( SCHED_FIFO ), priority, sched_get_priority_max( SCHED_FIFO ) );
+        if( pthread_setschedparam( pthread_self(), SCHED_FIFO, &param ) == 0 ) return;
+        //No rtprio permission: keep sending with normal priority
+        param.sched_priority = 0;
+    }
+    pthread_setschedparam( pthread_self(), SCHED_OTHER, &param );
+#else
+    Q_UNUSED( priority );
+#endif
+}
+
+//Delta needs a completely sent last patch with the same message layout, else a full dump is sent
+bool SynthPort::isDeltaPossible( const SysexPatchPtr &patch ) const
+{
+    if( m_lastSentPatch.isNull() ) return false;
+    if( m_lastSentPatch->messages.size() != patch->messages.size() ) return false;
+    for( size_t i = 0; i < patch->messages.size(); i++ )
+    {
+        if( m_lastSentPatch->messages[i].length != patch->messages[i].length ) return false;
+    }
+    return true;
+}
+
+//Set gap after each message (ms) and maximum data rate (0 = unlimited)
+void SynthPort::setPacing( int delayMs, int bytesPerSecond )
+{
+    m_delayMs = qMax( 0, delayMs );
+    m_bytesPerSecond = qMax( 0, bytesPerSecond );
+}
+
+//Wait until the next message may be sent, returns false if the job was cancelled meanwhile
+bool SynthPort::waitForNextMessage( int jobId, const QElapsedTimer &timer, qint64 lastSent, qint64 bytesSent )
+{
+    //Earliest time (ns since job start) for the next message
+    qint64 due = lastSent + (qint64)m_delayMs * 1000000;
+    if( m_bytesPerSecond > 0 ) due = qMax( due, bytesSent * 1000000000 / m_bytesPerSecond );
+
+    for(;;)
+    {
+        if( isCancelled( jobId ) ) return false;
+        qint64 remaining = due - timer.nsecsElapsed();
+        if( remaining <= 0 ) return true;
+        //Sleep in small steps to react fast on a new program change
+        QThread::usleep( (unsigned long)qMin( remaining / 1000, (qint64)5000 ) + 1 );
+    }
+}
+
+//Was the job replaced by a newer one?
+bool SynthPort::isCancelled( int jobId ) const
+{
+    return m_activeJob->load() != jobId;
+}
+
+//Asked by the driver while it waits for a full output buffer
+bool SynthPort::isSendCancelled( void *userData )
+{
+    SynthPort *port = static_cast<SynthPort*>( userData );
+    return port->isCancelled( port->m_jobId );
+}
+
+//Open the port with given index
+void SynthPort::open( int index )
+{
+    //Device may be gone in the meantime
+    qint64 start = LatencyStats::now();
+    try
+    {
+        m_midiOut->openPort( index );
+    }
+    catch( RtMidiError &error )
+    {
+        emit portError( m_slot, QString::fromStdString( error.getMessage() ) );
+        return;
+    }
+    m_latencyStats->recordSince( LatencyPortOpen, start );
+    if( m_midiOut->isPortOpen() ) m_portIndex = index;
+}
@@ -0,0 +1,69 @@
+/*!
+ * \file SynthPort.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief A long-living MIDI output connection for one synth slot
+ */
+
+#ifndef SYNTHPORT_H
+#define SYNTHPORT_H
+
+#include <QObject>
+#include <QStringList>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include "qmidiout.h"
+#include "PatchCache.h"
+#include "LatencyStats.h"
+
+//Unpaced sending hands the driver this many bytes at once, a newer job aborts in between
+#define SYNTHPORT_BATCH_BYTES 4096
+
+class SynthPort : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SynthPort( int slot, const QAtomicInt *activeJob, LatencyStats *latencyStats, QObject *parent = 0 );
+    ~SynthPort();
+    int slot( void ) const;
+    QString portName( void ) const;
+    bool isOpen( void );
+
+public slots:
+    void setPortName( const QString &portName, const QStringList &ports );
+    void reconnect( const QStringList &ports );
+    void close( void );
+    void send( int jobId, SysexPatchPtr patch, qint64 submitted );
+    void setPacing( int delayMs, int bytesPerSecond );
+    void setDeltaMode( bool enabled );
+    void forgetLastPatch( void );
+    void setRealtime( int priority );
+
+signals:
+    void progress( int jobId, int slot, int bytesSent );
+    void sent( int jobId, int slot, bool cancelled, qint64 finishedAt );
+    void portError( int slot, const QString &message );
+
+private:
+    void open( int index );
+    bool isCancelled( int jobId ) const;
+    static bool isSendCancelled( void *userData );
+    bool isDeltaPossible( const SysexPatchPtr &patch ) const;
+    bool waitForNextMessage( int jobId, const QElapsedTimer &timer, qint64 lastSent, qint64 bytesSent );
+    bool flushBatch( int jobId, const unsigned char *data, size_t offset, size_t length, qint64 bytesDone );
+    void sendBatch( const unsigned char *data, size_t offset, size_t length );
+
+    int m_slot;
+    int m_jobId;
+    int m_portIndex;
+    QString m_portName;
+    QMidiOut *m_midiOut;
+    const QAtomicInt *m_activeJob;
+    LatencyStats *m_latencyStats;
+    int m_delayMs;
+    int m_bytesPerSecond;
+    bool m_deltaMode;
+    SysexPatchPtr m_lastSentPatch;
+};
+
+#endif // SYNTHPORT_H
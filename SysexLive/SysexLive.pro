@@ -10,6 +10,7 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = SysexLive
 TEMPLATE = app
+CONFIG += c++11
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
@@ -27,13 +28,41 @@ SOURCES += \
         main.cpp \
         MainWindow.cpp \
     QRecentFilesMenu.cpp \
-    EventReturnFilter.cpp
+    EventReturnFilter.cpp \
+    PatchCache.cpp \
+    SynthPort.cpp \
+    SendEngine.cpp \
+    ProgramChangeCoalescer.cpp \
+    SysexSplitter.cpp \
+    PacingDialog.cpp \
+    Prefetcher.cpp \
+    LatencyStats.cpp \
+    LatencyDialog.cpp \
+    ProgramChangeFastPath.cpp \
+    ProgramMap.cpp \
+    ProgramAddressDialog.cpp \
+    InputPortsDialog.cpp \
+    RealtimeDialog.cpp
 
 HEADERS += \
         MainWindow.h \
     DarkStyle.h \
     QRecentFilesMenu.h \
-    EventReturnFilter.h
+    EventReturnFilter.h \
+    PatchCache.h \
+    SynthPort.h \
+    SendEngine.h \
+    ProgramChangeCoalescer.h \
+    SysexSplitter.h \
+    PacingDialog.h \
+    Prefetcher.h \
+    LatencyStats.h \
+    LatencyDialog.h \
+    ProgramChangeFastPath.h \
+    ProgramMap.h \
+    ProgramAddressDialog.h \
+    InputPortsDialog.h \
+    RealtimeDialog.h
 
 FORMS += \
         MainWindow.ui
@@ -0,0 +1,40 @@
+/*!
+ * \file SysexSplitter.cpp
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Finds the single F0...F7 messages in a sysex file
+ */
+
+#include "SysexSplitter.h"
+
+#define SYX_START 0xF0
+#define SYX_END   0xF7
+
+//Index all messages. Sysex is F0...F7, any other bytes in between form messages on their own.
+void SysexSplitter::split( const unsigned char *data, size_t size, std::vector<SysexMessage> &messages )
+{
+    messages.clear();
+
+    size_t start = 0;
+    while( start < size )
+    {
+        size_t end = start + 1;
+        if( data[start] == SYX_START )
+        {
+            //Up to F7, a new F0 ends a truncated message
+            while( end < size && data[end] != SYX_END && data[end] != SYX_START ) end++;
+            if( end < size && data[end] == SYX_END ) end++;
+        }
+        else
+        {
+            //Not sysex (e.g. channel messages), keep it together up to the next F0
+            while( end < size && data[end] != SYX_START ) end++;
+        }
+
+        SysexMessage message;
+        message.offset = start;
+        message.length = end - start;
+        messages.push_back( message );
+        start = end;
+    }
+}
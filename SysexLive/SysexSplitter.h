@@ -0,0 +1,27 @@
+/*!
+ * \file SysexSplitter.h
+ * \author masc4ii
+ * \copyright 2018
+ * \brief Finds the single F0...F7 messages in a sysex file
+ */
+
+#ifndef SYSEXSPLITTER_H
+#define SYSEXSPLITTER_H
+
+#include <vector>
+#include <cstddef>
+
+//Position of one message inside the file data
+struct SysexMessage
+{
+    size_t offset;
+    size_t length;
+};
+
+class SysexSplitter
+{
+public:
+    static void split( const unsigned char *data, size_t size, std::vector<SysexMessage> &messages );
+};
+
+#endif // SYSEXSPLITTER_H